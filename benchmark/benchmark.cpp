@@ -0,0 +1,515 @@
+#include "benchmark.h"
+
+#include "highlightoptions.h"
+#include "logreader.h"
+#include "logtab.h"
+#include "options.h"
+#include "qjsonutils.h"
+#include "treemodel.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QtGlobal>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    // Events normalized and formatted per run. Those work on one event at a time, so a sample is enough.
+    const int TextSampleSize = 20000;
+    // Start of the synthetic logs, 2024-03-01T09:00:00 UTC
+    const qint64 StartMSecs = 1709283600000;
+
+    qint64 PeakResidentBytes()
+    {
+#if defined(Q_OS_WIN)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return -1;
+        return static_cast<qint64>(counters.PeakWorkingSetSize);
+#else
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return -1;
+#if defined(Q_OS_MACOS)
+        return usage.ru_maxrss;
+#else
+        // Kilobytes on Linux
+        return static_cast<qint64>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+    }
+
+    // Deterministic pieces of synthetic events
+    class EventGenerator
+    {
+    public:
+        EventGenerator(Benchmark::LogStyle style, quint32 seed) :
+            m_style(style),
+            m_random(seed),
+            m_msecs(StartMSecs)
+        {
+        }
+
+        QByteArray NextLine(int index)
+        {
+            m_msecs += m_random.bounded(5);
+            QString ts = QDateTime::fromMSecsSinceEpoch(m_msecs, Qt::UTC).toString("yyyy-MM-ddTHH:mm:ss.zzz");
+            if (m_style == Benchmark::LogStyle::Hyper)
+                ts += QString::number(m_random.bounded(1000)).rightJustified(3, '0');
+
+            QString key;
+            QJsonObject value = (m_style == Benchmark::LogStyle::Hyper) ? HyperValue(key) : VizqlValue(key);
+
+            // Real logs start with "ts", which a QJsonObject would sort after the other keys
+            QByteArray line = QString("{\"ts\":\"%1\",\"pid\":%2,\"tid\":\"%3\",\"sev\":\"%4\",\"req\":\"%5\","
+                                      "\"sess\":\"%6\",\"site\":\"%7\",\"user\":\"%8\",\"k\":\"%9\",\"v\":")
+                .arg(ts)
+                .arg(m_style == Benchmark::LogStyle::Hyper ? 5120 : 4096)
+                .arg(QString::number(0x1a00 + m_random.bounded(16), 16))
+                .arg(Pick({"info", "info", "info", "info", "debug", "warn", "error"}))
+                .arg(QString("Zf%1AAAB").arg(index / 500, 4, 16, QChar('0')))
+                .arg(QString("%1-0:0").arg(QString::number(0xA1B2C3 + index / 2000, 16).toUpper()))
+                .arg(Pick({"Default", "Marketing", "Finance"}))
+                .arg(Pick({"alice", "bob", "carol", "dave"}))
+                .arg(key)
+                .toUtf8();
+            line += QJsonDocument(value).toJson(QJsonDocument::Compact);
+            if (m_style == Benchmark::LogStyle::VizqlServer && m_random.bounded(3) == 0)
+            {
+                QJsonObject activity{
+                    {"depth", m_random.bounded(1, 4)},
+                    {"elapsed", Elapsed()},
+                    {"vw", "Sheet " + QString::number(m_random.bounded(1, 12))},
+                    {"wb", "Sales Overview"},
+                };
+                line += ",\"a\":" + QJsonDocument(activity).toJson(QJsonDocument::Compact);
+            }
+            line += "}\n";
+            return line;
+        }
+
+    private:
+        QString Pick(std::initializer_list<const char*> values)
+        {
+            return QString(*(values.begin() + m_random.bounded(static_cast<int>(values.size()))));
+        }
+
+        double Elapsed()
+        {
+            return m_random.bounded(100000) / 1000.0;
+        }
+
+        // SQL of 100 bytes to a few kilobytes, like most of the queries in real logs
+        QString Query()
+        {
+            static const char* columns[] = {"Region", "Category", "Sub-Category", "Order Date", "Sales", "Profit", "Quantity"};
+            QString query = "SELECT ";
+            const int columnCount = m_random.bounded(2, 40);
+            for (int i = 0; i < columnCount; i++)
+            {
+                const char* column = columns[m_random.bounded(7)];
+                query += QString("SUM(\"Orders\".\"%1\") AS \"sum:%1:%2\", ").arg(column).arg(i);
+            }
+            query += QString("FROM \"#Tableau_%1_%2_Connect\" \"Orders\" GROUP BY 1")
+                .arg(m_random.bounded(100)).arg(m_random.bounded(100000));
+            if (m_random.bounded(8) == 0)
+                query += QString(" JOIN \"FQ_Temp_%1\" ON 1 = 1").arg(m_random.bounded(1000));
+            return query;
+        }
+
+        QJsonObject VizqlValue(QString& key)
+        {
+            const int kind = m_random.bounded(100);
+            if (kind < 20)
+            {
+                key = "end-query";
+                return {
+                    {"cols", m_random.bounded(1, 40)},
+                    {"elapsed", Elapsed()},
+                    {"protocol-id", m_random.bounded(1, 50)},
+                    {"query", Query()},
+                    {"query-category", Pick({"Data", "Metadata", "Other"})},
+                    {"query-hash", static_cast<double>(m_random.bounded(std::numeric_limits<int>::max()))},
+                    {"rows", m_random.bounded(100000)},
+                };
+            }
+            if (kind < 30)
+            {
+                key = "begin-query";
+                return {
+                    {"query", Query()},
+                    {"query-category", Pick({"Data", "Metadata", "Other"})},
+                    {"protocol-id", m_random.bounded(1, 50)},
+                };
+            }
+            if (kind < 40)
+            {
+                key = "qp-batch-summary";
+                QJsonArray jobs;
+                const int jobCount = m_random.bounded(1, 6);
+                for (int i = 0; i < jobCount; i++)
+                {
+                    jobs.append(QJsonObject{
+                        {"elapsed", Elapsed()},
+                        {"owner-component", "Viz"},
+                        {"query-compiled", Query().left(400)},
+                        {"fusion-parent", QJsonObject{{"id", i}, {"children", QJsonArray{i + 1, i + 2}}}},
+                    });
+                }
+                return {{"elapsed", Elapsed()}, {"job-count", jobCount}, {"jobs", jobs}};
+            }
+            if (kind < 45)
+            {
+                key = "command-post";
+                return {
+                    {"args", QString("tabui:open-workbook workbook=\"Sales %1.twbx\"").arg(m_random.bounded(20))},
+                    {"name", "tabui:open-workbook"},
+                };
+            }
+            if (kind < 50)
+            {
+                key = "construct-protocol";
+                return {
+                    {"created-elapsed", Elapsed()},
+                    {"id", m_random.bounded(1, 50)},
+                    {"attributes", QJsonObject{
+                        {"class", Pick({"hyper", "postgres", "sqlserver"})},
+                        {"dbname", "TableauTemp/tde_" + QString::number(m_random.generate64(), 36)},
+                        {"server", QString("db%1.example.com").arg(m_random.bounded(5))},
+                    }},
+                };
+            }
+            if (kind < 55)
+            {
+                key = "end-sql-temp-table-tuples-create";
+                return {
+                    {"elapsed", Elapsed()},
+                    {"elapsed-create", Elapsed()},
+                    {"elapsed-insert", Elapsed()},
+                    {"num-columns", m_random.bounded(1, 20)},
+                    {"num-tuples", m_random.bounded(1, 100000)},
+                    {"protocol-id", m_random.bounded(1, 50)},
+                    {"tablename", QString("[#Tableau_%1_Filter]").arg(m_random.bounded(100))},
+                };
+            }
+            if (kind < 57)
+            {
+                key = "dll-version-info";
+                return {{"name", "tabquery.dll"}, {"version", "20241.24.0301.0900"}};
+            }
+            key = Pick({"lock-session", "unlock-session", "msg", "read-metadata", "end-update-sheet"});
+            return {
+                {"elapsed", Elapsed()},
+                {"msg", QString("pid=%1 sheet %2 this: 0x%3").arg(m_random.bounded(10000))
+                            .arg(m_random.bounded(12)).arg(QString::number(m_random.generate64(), 16))},
+            };
+        }
+
+        // Plans nest a few levels deep, like the query-end events of Hyper
+        QJsonObject PlanNode(int depth)
+        {
+            QJsonObject node{
+                {"operator", Pick({"tablescan", "groupby", "join", "sort", "select"})},
+                {"rows", m_random.bounded(1000000)},
+                {"elapsed", Elapsed()},
+            };
+            if (depth > 0)
+            {
+                QJsonArray children;
+                const int childCount = m_random.bounded(1, 3);
+                for (int i = 0; i < childCount; i++)
+                {
+                    children.append(PlanNode(depth - 1));
+                }
+                node["children"] = children;
+            }
+            return node;
+        }
+
+        QJsonObject HyperValue(QString& key)
+        {
+            const int kind = m_random.bounded(100);
+            if (kind < 30)
+            {
+                key = "query-end";
+                return {
+                    {"statement-id", m_random.bounded(100000)},
+                    {"elapsed", Elapsed()},
+                    {"query-trunc", Query().left(1000)},
+                    {"result-size-mb", m_random.bounded(1000) / 10.0},
+                    {"plan", PlanNode(m_random.bounded(1, 5))},
+                };
+            }
+            if (kind < 45)
+            {
+                key = "cmd-stats";
+                return {
+                    {"command-count", m_random.bounded(1000)},
+                    {"elapsed", Elapsed()},
+                    {"peak-memory-mb", m_random.bounded(10000)},
+                };
+            }
+            if (kind < 55)
+            {
+                key = "connection-startup-begin";
+                return {
+                    {"db-user", "tableau_internal_user"},
+                    {"database", "#TableauTemp_" + QString::number(m_random.generate64(), 36) + ".hyper"},
+                    {"client-session-id", QString::number(m_random.generate64(), 16)},
+                };
+            }
+            if (kind < 60)
+            {
+                key = "tcp-ip-connection";
+                return {{"port", m_random.bounded(1024, 65535)}, {"address", "127.0.0.1"}};
+            }
+            key = Pick({"query-result-sent", "resource-stats", "log-rate-limit-reached"});
+            return {
+                {"elapsed", Elapsed()},
+                {"memory", QJsonObject{{"virtual-mb", m_random.bounded(10000)}, {"resident-mb", m_random.bounded(10000)}}},
+            };
+        }
+
+        Benchmark::LogStyle m_style;
+        QRandomGenerator m_random;
+        qint64 m_msecs;
+    };
+
+    // Runs setup then func `runs` times and records the best time of func
+    QJsonObject TimeScenario(const QString& name, int runs, qint64 items, qint64 bytes,
+                             const std::function<void()>& setup, const std::function<void()>& func)
+    {
+        qint64 bestNSecs = std::numeric_limits<qint64>::max();
+        for (int run = 0; run < runs; run++)
+        {
+            if (setup)
+                setup();
+            QElapsedTimer timer;
+            timer.start();
+            func();
+            bestNSecs = std::min(bestNSecs, timer.nsecsElapsed());
+        }
+
+        const double seconds = std::max<qint64>(bestNSecs, 1) / 1e9;
+        QJsonObject result{
+            {"name", name},
+            {"runs", runs},
+            {"items", items},
+            {"seconds", seconds},
+            {"itemsPerSecond", items / seconds},
+            {"peakRssBytes", PeakResidentBytes()},
+        };
+        if (bytes > 0)
+        {
+            result["bytes"] = bytes;
+            result["megabytesPerSecond"] = bytes / seconds / (1024 * 1024);
+        }
+        return result;
+    }
+
+    // Sets the options that change what is timed to fixed values for the life of the object, so
+    // results don't depend on the settings of the machine. Puts the settings back after.
+    class PinnedOptions
+    {
+    public:
+        PinnedOptions() :
+            m_options(Options::GetInstance()),
+            m_skippedText(m_options.getSkippedText()),
+            m_skippedState(m_options.getSkippedState()),
+            m_defaultHighlightOpts(m_options.getDefaultHighlightOpts()),
+            m_searchRawValue(m_options.getSearchRawValue()),
+            m_notation(m_options.getNotation()),
+            m_showArtDataInValue(m_options.getShowArtDataInValue()),
+            m_showErrorCodeInValue(m_options.getShowErrorCodeInValue()),
+            m_elapsedKeys(m_options.getElapsedKeys()),
+            m_elapsedMsKeys(m_options.getElapsedMsKeys()),
+            m_indexLargeLogs(m_options.getIndexLargeLogs())
+        {
+            const QStringList skippedText = {"dll-version-info", "ds-interpret-metadata"};
+            m_options.setSkippedText(skippedText);
+            m_options.setSkippedState(QBitArray(skippedText.size(), true));
+            m_options.setDefaultHighlightOpts(HighlightOptions());
+            m_options.setSearchRawValue(false);
+            m_options.setNotation("YAML");
+            m_options.setShowArtDataInValue(false);
+            m_options.setShowErrorCodeInValue(false);
+            m_options.setElapsedKeys({"elapsed", "created-elapsed"});
+            m_options.setElapsedMsKeys({"elapsedMs", "elapsed-ms"});
+            // Time the parser rather than the event index
+            m_options.setIndexLargeLogs(false);
+        }
+
+        ~PinnedOptions()
+        {
+            m_options.setSkippedText(m_skippedText);
+            m_options.setSkippedState(m_skippedState);
+            m_options.setDefaultHighlightOpts(m_defaultHighlightOpts);
+            m_options.setSearchRawValue(m_searchRawValue);
+            m_options.setNotation(m_notation);
+            m_options.setShowArtDataInValue(m_showArtDataInValue);
+            m_options.setShowErrorCodeInValue(m_showErrorCodeInValue);
+            m_options.setElapsedKeys(m_elapsedKeys);
+            m_options.setElapsedMsKeys(m_elapsedMsKeys);
+            m_options.setIndexLargeLogs(m_indexLargeLogs);
+        }
+
+    private:
+        Options& m_options;
+        const QStringList m_skippedText;
+        const QBitArray m_skippedState;
+        const HighlightOptions m_defaultHighlightOpts;
+        const bool m_searchRawValue;
+        const QString m_notation;
+        const bool m_showArtDataInValue;
+        const bool m_showErrorCodeInValue;
+        const QStringList m_elapsedKeys;
+        const QStringList m_elapsedMsKeys;
+        const bool m_indexLargeLogs;
+    };
+}
+
+namespace Benchmark
+{
+    bool WriteSyntheticLog(const QString& path, LogStyle style, int eventCount, quint32 seed)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+
+        EventGenerator generator(style, seed);
+        for (int i = 0; i < eventCount; i++)
+        {
+            if (file.write(generator.NextLine(i)) < 0)
+                return false;
+        }
+        return true;
+    }
+
+    QJsonObject Run(int eventCount, quint32 seed, int runs, QString& error)
+    {
+        QTemporaryDir dir;
+        const QString vizqlPath = dir.filePath("vizqlserver_1.txt");
+        const QString hyperPath = dir.filePath("hyperd_1.txt");
+        if (!dir.isValid() ||
+            !WriteSyntheticLog(vizqlPath, LogStyle::VizqlServer, eventCount, seed) ||
+            !WriteSyntheticLog(hyperPath, LogStyle::Hyper, eventCount, seed + 1))
+        {
+            error = QString("Cannot write the synthetic logs to \"%1\"").arg(dir.path());
+            return QJsonObject();
+        }
+
+        PinnedOptions pinnedOptions;
+
+        QJsonArray scenarios;
+        EventListPtr vizqlEvents;
+        EventListPtr hyperEvents;
+        int skippedCount = 0;
+        scenarios.append(TimeScenario("load-vizqlserver", runs, eventCount, QFileInfo(vizqlPath).size(), nullptr, [&]() {
+            vizqlEvents = LogReader::ReadEvents(vizqlPath, skippedCount);
+        }));
+        scenarios.append(TimeScenario("load-hyper", runs, eventCount, QFileInfo(hyperPath).size(), nullptr, [&]() {
+            hyperEvents = LogReader::ReadEvents(hyperPath, skippedCount);
+        }));
+
+        std::unique_ptr<TreeModel> model;
+        scenarios.append(TimeScenario("model", runs, vizqlEvents->size(), 0, [&]() { model.reset(); }, [&]() {
+            model = std::make_unique<TreeModel>(LogTab::ColumnHeaders(), vizqlEvents);
+        }));
+
+        scenarios.append(TimeScenario("merge", runs, hyperEvents->size(), 0, [&]() {
+            model = std::make_unique<TreeModel>(LogTab::ColumnHeaders(), vizqlEvents);
+        }, [&]() {
+            model->MergeIntoModelData(*hyperEvents);
+        }));
+
+        // A search that matches nothing looks at every row, like Find next on a missing text
+        const int rowCount = model->rowCount();
+        SearchOpt findOpt;
+        findOpt.m_value = "no such text in the synthetic logs";
+        findOpt.m_keys = {COL::Key, COL::Value};
+        int findCount = 0;
+        scenarios.append(TimeScenario("find", runs, rowCount, 0, [&]() { model->ClearSearchCache(); }, [&]() {
+            for (int row = 0; row < rowCount; row++)
+            {
+                if (findOpt.HasMatch(model->index(row, COL::Key).data().toString()) ||
+                    findOpt.HasMatch(model->GetValueSearchString(model->index(row, COL::Value))))
+                {
+                    findCount++;
+                }
+            }
+        }));
+
+        HighlightOptions highlightOpts;
+        for (const auto& filter : std::initializer_list<std::pair<const char*, SearchMode>>{
+                 {"end-query", SearchMode::Equals},
+                 {"#TableauTemp_", SearchMode::Contains},
+                 {"\"elapsed\":[1-9]\\d\\.", SearchMode::Regex}})
+        {
+            SearchOpt highlightOpt;
+            highlightOpt.m_value = filter.first;
+            highlightOpt.m_mode = filter.second;
+            highlightOpt.m_keys = (filter.second == SearchMode::Equals) ? QVector<COL>{COL::Key} : QVector<COL>{COL::Value};
+            highlightOpts.append(highlightOpt);
+        }
+        scenarios.append(TimeScenario("highlight", runs, rowCount, 0, [&]() {
+            model->SetHighlightFilters(HighlightOptions());
+            model->ClearSearchCache();
+        }, [&]() {
+            model->SetHighlightFilters(highlightOpts);
+        }));
+
+        // Normalizing and formatting work on the value of one event at a time
+        const int sampleSize = std::min(rowCount, TextSampleSize);
+        QStringList texts;
+        qint64 textBytes = 0;
+        for (int row = 0; row < sampleSize; row++)
+        {
+            texts.append(model->GetValueFullString(model->index(row, COL::Value)));
+            textBytes += texts.back().toUtf8().size();
+        }
+        scenarios.append(TimeScenario("normalize", runs, sampleSize, textBytes, nullptr, [&]() {
+            for (QString text : texts)
+            {
+                NormalizeLogText(text);
+            }
+        }));
+
+        for (auto notation : {QJsonUtils::Notation::JSON, QJsonUtils::Notation::YAML, QJsonUtils::Notation::Flat})
+        {
+            QString name = "format-" + QJsonUtils::GetNameForNotation(notation).toLower();
+            scenarios.append(TimeScenario(name, runs, sampleSize, 0, nullptr, [&]() {
+                for (int row = 0; row < sampleSize; row++)
+                {
+                    QJsonUtils::Format(model->GetEvent(model->index(row, 0))["v"], notation);
+                }
+            }));
+        }
+
+        return QJsonObject{
+            {"version", QCoreApplication::applicationVersion()},
+            {"qt", qVersion()},
+            {"threads", QThread::idealThreadCount()},
+            {"seed", static_cast<qint64>(seed)},
+            {"events", eventCount},
+            {"scenarios", scenarios},
+        };
+    }
+}
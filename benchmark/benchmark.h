@@ -0,0 +1,29 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QJsonObject>
+#include <QString>
+
+// Timing of the hot paths of the viewer on synthetic logs, so a release can be compared to the
+// one before it. The logs come from a seeded generator, so the same seed and size give the same
+// bytes on every machine.
+namespace Benchmark
+{
+    enum class LogStyle
+    {
+        VizqlServer,
+        Hyper
+    };
+
+    // Writes eventCount events in the style of a vizqlserver or a Hyper log: a mix of keys seen in
+    // real logs, long query texts and values nested a few levels deep
+    bool WriteSyntheticLog(const QString& path, LogStyle style, int eventCount, quint32 seed);
+
+    // Times loading, building the model, merging, finding, highlighting, normalizing and formatting
+    // on synthetic logs of eventCount events. Each scenario runs `runs` times and reports its best
+    // time, its throughput and the peak resident memory of the process after it.
+    // Returns an empty object and sets error when the logs cannot be written.
+    QJsonObject Run(int eventCount, quint32 seed, int runs, QString& error);
+}
+
+#endif // BENCHMARK_H
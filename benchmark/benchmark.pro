@@ -0,0 +1,19 @@
+# Times the hot paths of the viewer on synthetic logs. Built from the same sources as the viewer.
+include(../src/tableau-log-viewer.pri)
+
+TARGET = "tlv-benchmark"
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG += x86_64
+
+# Peak resident memory of the process
+win32: LIBS += -lpsapi
+
+HEADERS    += \
+    benchmark.h
+
+SOURCES    += \
+    benchmark.cpp \
+    main.cpp
@@ -0,0 +1,87 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QTextStream>
+
+#include "benchmark.h"
+#include "trace.h"
+
+int main(int argc, char *argv[])
+{
+    Q_INIT_RESOURCE(resources);
+
+    // The model uses colors and fonts, but nothing is shown, so no display is needed
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    app.setOrganizationName("Tableau");
+    app.setApplicationName("TLV Benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Times the viewer on synthetic logs and writes the results as JSON.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"generate", "Only write synthetic vizqlserver and Hyper logs to a folder.", "folder"},
+        {"events", "Events of each synthetic log (default: 200000).", "count", "200000"},
+        {"seed", "Seed of the synthetic logs (default: 1).", "seed", "1"},
+        {"runs", "Runs of each scenario (default: 3).", "count", "3"},
+        {"output", "File of the results (default: standard output).", "path"},
+        {"trace", "Record the time taken by each phase into a Chrome trace JSON file.", "file"},
+    });
+    parser.process(app);
+
+    QTextStream err(stderr);
+    bool isEventCountValid, isSeedValid, isRunCountValid;
+    const int eventCount = parser.value("events").toInt(&isEventCountValid);
+    const quint32 seed = parser.value("seed").toUInt(&isSeedValid);
+    const int runs = parser.value("runs").toInt(&isRunCountValid);
+    if (!isEventCountValid || eventCount <= 0 || !isSeedValid || !isRunCountValid || runs <= 0)
+    {
+        err << "--events and --runs must be positive numbers, and --seed a number\n";
+        return 2;
+    }
+
+    if (parser.isSet("generate"))
+    {
+        QDir folder(parser.value("generate"));
+        if (!folder.mkpath(".") ||
+            !Benchmark::WriteSyntheticLog(folder.filePath("vizqlserver_1.txt"), Benchmark::LogStyle::VizqlServer, eventCount, seed) ||
+            !Benchmark::WriteSyntheticLog(folder.filePath("hyperd_1.txt"), Benchmark::LogStyle::Hyper, eventCount, seed + 1))
+        {
+            err << QString("Cannot write the synthetic logs to \"%1\"\n").arg(folder.path());
+            return 1;
+        }
+        return 0;
+    }
+
+    if (parser.isSet("trace"))
+        Trace::SetRecording(true);
+
+    QString error;
+    QJsonObject results = Benchmark::Run(eventCount, seed, runs, error);
+    if (results.isEmpty())
+    {
+        err << error << "\n";
+        return 1;
+    }
+
+    const QString outputPath = parser.value("output");
+    QFile file(outputPath);
+    bool isOpen = outputPath.isEmpty() ?
+        file.open(stdout, QIODevice::WriteOnly) :
+        file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    if (!isOpen || file.write(QJsonDocument(results).toJson()) < 0)
+    {
+        err << QString("Cannot write \"%1\"\n").arg(outputPath);
+        return 1;
+    }
+
+    if (parser.isSet("trace") && !Trace::Save(parser.value("trace"), error))
+    {
+        err << QString("Cannot write the trace \"%1\": %2\n").arg(parser.value("trace"), error);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,488 @@
+#include "batchmode.h"
+
+#include "compressedfile.h"
+#include "highlightoptions.h"
+#include "loadfilter.h"
+#include "logreader.h"
+#include "logtab.h"
+#include "logtree.h"
+#include "parallelutils.h"
+#include "pathhelper.h"
+#include "processevent.h"
+#include "reports.h"
+#include "timeutils.h"
+#include "trace.h"
+#include "treemodel.h"
+#include "ziparchive.h"
+
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <QtConcurrent>
+
+namespace
+{
+    // Bytes of a log read at a time when its lines are streamed out, so memory stays bounded
+    // however many logs are merged
+    const qint64 LineChunkSize = 256 * 1024;
+
+    QTextStream& Err()
+    {
+        static QTextStream stream(stderr);
+        return stream;
+    }
+
+    QSet<QString> SplitValues(const QStringList& texts, bool isLowerCase = false)
+    {
+        QSet<QString> values;
+        static const QRegularExpression separators("[,\\s]+");
+        for (const QString& text : texts)
+        {
+            for (const QString& value : text.split(separators, Qt::SkipEmptyParts))
+            {
+                values.insert(isLowerCase ? value.toLower() : value);
+            }
+        }
+        return values;
+    }
+
+    bool ParseTime(const QCommandLineParser& parser, const QString& option, qint64& usecs)
+    {
+        if (!parser.isSet(option))
+            return true;
+        if (TimeUtils::ParseTimestamp(parser.value(option).trimmed(), usecs))
+            return true;
+
+        Err() << QString("Invalid --%1 time \"%2\". Use yyyy-MM-ddTHH:mm:ss.zzz\n").arg(option, parser.value(option));
+        return false;
+    }
+
+    // A highlight filter file, or the name of a filter saved from the File menu
+    bool ReadHighlightFilters(const QString& nameOrPath, HighlightOptions& highlightOpts)
+    {
+        QString path = nameOrPath;
+        if (!QFileInfo::exists(path))
+            path = QDir(PathHelper::GetFiltersConfigPath()).filePath(nameOrPath + ".json");
+
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            Err() << QString("Cannot open the highlight filters \"%1\"\n").arg(nameOrPath);
+            return false;
+        }
+        QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+        if (!doc.isArray())
+        {
+            Err() << QString("\"%1\" is not a highlight filter file\n").arg(path);
+            return false;
+        }
+        highlightOpts = HighlightOptions(doc.array());
+        return true;
+    }
+
+    // Hides the rows that don't match any of the filters
+    void KeepMatchingRows(TreeModel* model, const HighlightOptions& highlightOpts)
+    {
+        model->SetHighlightFilters(highlightOpts);
+        QVector<int> rows;
+        for (int row = 0; row < model->rowCount(); row++)
+        {
+            if (!model->IsHiddenRow(row) && !model->IsHighlightedRow(row))
+                rows.append(row);
+        }
+        model->HideRows(rows);
+    }
+
+    struct KeptLine
+    {
+        qint64 time;
+        // "idx" of the event, its line number among the non-empty lines
+        int index;
+        QByteArray text;
+    };
+
+    // The lines of a log that become events, as they are in the log. The next chunk is read and
+    // parsed on the thread pool while the current one is used, so several logs are read at once.
+    class LineSource
+    {
+    public:
+        LineSource(const QString& path, const QString& fileName, const LoadFilter* filter) :
+            m_fileName(fileName),
+            m_filter(filter)
+        {
+            if (CompressedFile::IsCompressed(path))
+                m_device = std::make_unique<CompressedFile>(path);
+            else
+                m_device = std::make_unique<QFile>(path);
+        }
+
+        ~LineSource()
+        {
+            m_nextChunk.waitForFinished();
+        }
+
+        bool Open()
+        {
+            if (!m_device->open(QIODevice::ReadOnly))
+                return false;
+            m_nextChunk = QtConcurrent::run([this]() { return ReadChunk(); });
+            m_isChunkPending = true;
+            TakeChunk();
+            return true;
+        }
+
+        bool AtEnd() const
+        {
+            return m_position >= m_lines.size();
+        }
+
+        const KeptLine& Line() const
+        {
+            return m_lines[m_position];
+        }
+
+        void Next()
+        {
+            if (++m_position >= m_lines.size())
+                TakeChunk();
+        }
+
+        int SkippedCount() const
+        {
+            return m_skippedCount;
+        }
+
+    private:
+        // Waits for the next chunk that has lines, and starts reading the one after it
+        void TakeChunk()
+        {
+            m_lines.clear();
+            m_position = 0;
+            while (m_lines.empty() && m_isChunkPending)
+            {
+                m_lines = m_nextChunk.result();
+                m_isChunkPending = !m_isDeviceAtEnd;
+                if (m_isChunkPending)
+                    m_nextChunk = QtConcurrent::run([this]() { return ReadChunk(); });
+            }
+        }
+
+        std::vector<KeptLine> ReadChunk()
+        {
+            std::vector<KeptLine> lines;
+            qint64 bytes = 0;
+            while (bytes < LineChunkSize && !m_device->atEnd())
+            {
+                QByteArray line = m_device->readLine();
+                bytes += line.size();
+                line = line.trimmed();
+                if (line.isEmpty())
+                    continue;
+
+                QJsonObject event = ProcessEvent::ProcessLogEventMessage(++m_lineCount, line, m_fileName, m_filter);
+                if (event.isEmpty())
+                {
+                    m_skippedCount++;
+                    continue;
+                }
+                // Events without a timestamp come first, like in LogTree::MergeByTime
+                qint64 time;
+                if (!TimeUtils::ParseTimestamp(event["ts"].toString(), time))
+                    time = std::numeric_limits<qint64>::min();
+                lines.push_back({time, m_lineCount, line});
+            }
+            m_isDeviceAtEnd = m_device->atEnd();
+            return lines;
+        }
+
+        const QString m_fileName;
+        const LoadFilter* m_filter;
+        std::unique_ptr<QIODevice> m_device;
+        QFuture<std::vector<KeptLine>> m_nextChunk;
+        bool m_isChunkPending = false;
+        std::vector<KeptLine> m_lines;
+        size_t m_position = 0;
+        // Only touched by ReadChunk, which never runs twice at once
+        int m_lineCount = 0;
+        int m_skippedCount = 0;
+        bool m_isDeviceAtEnd = false;
+    };
+
+    // Writes the lines of the logs that become events, merged on time in the order a tab shows
+    // them. Without a model, so it keeps a few chunks of each log rather than all of their events.
+    // With keptLines, only the lines whose file and "idx" are marked in it are written.
+    bool StreamJsonLines(const QStringList& files, const QStringList& fileNames, const LoadFilter* filter,
+                         const QString& outputPath, const std::vector<std::vector<bool>>* keptLines,
+                         qint64& writtenCount, int& skippedCount)
+    {
+        QFile file(outputPath);
+        bool isOpen = outputPath.isEmpty() ?
+            file.open(stdout, QIODevice::WriteOnly) :
+            file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        if (!isOpen)
+        {
+            Err() << QString("Cannot write \"%1\"\n").arg(outputPath);
+            return false;
+        }
+
+        const int fileCount = static_cast<int>(files.size());
+        std::vector<std::unique_ptr<LineSource>> sources;
+        for (int i = 0; i < fileCount; i++)
+        {
+            sources.push_back(std::make_unique<LineSource>(files[i], fileNames[i], filter));
+            if (!sources.back()->Open())
+                Err() << QString("Cannot read \"%1\"\n").arg(files[i]);
+        }
+
+        // Next line of each log, earliest first and the first log on ties
+        typedef std::pair<qint64, int> Head;
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+        for (int i = 0; i < fileCount; i++)
+        {
+            if (!sources[i]->AtEnd())
+                heads.emplace(sources[i]->Line().time, i);
+        }
+
+        writtenCount = 0;
+        while (!heads.empty())
+        {
+            const int source = heads.top().second;
+            heads.pop();
+            const KeptLine& line = sources[source]->Line();
+            const std::vector<bool>* kept = keptLines ? &(*keptLines)[source] : nullptr;
+            if (!kept || (line.index < static_cast<int>(kept->size()) && (*kept)[line.index]))
+            {
+                if (file.write(line.text) < 0 || !file.putChar('\n'))
+                {
+                    Err() << QString("Cannot write \"%1\": %2\n").arg(outputPath, file.errorString());
+                    return false;
+                }
+                writtenCount++;
+            }
+            sources[source]->Next();
+            if (!sources[source]->AtEnd())
+                heads.emplace(sources[source]->Line().time, source);
+        }
+        file.flush();
+
+        skippedCount = 0;
+        for (const auto& source : sources)
+        {
+            skippedCount += source->SkippedCount();
+        }
+        return true;
+    }
+
+    int RunQuery(const QCommandLineParser& parser)
+    {
+        const QString format = parser.value("format");
+        if (format != "jsonl" && format != "summary" && format != "csv")
+        {
+            Err() << QString("Unknown --format \"%1\"\n").arg(format);
+            return 2;
+        }
+
+        LoadFilter filter;
+        filter.includeKeys = SplitValues(parser.values("key"));
+        filter.excludeKeys = SplitValues(parser.values("exclude-key"));
+        filter.severities = SplitValues(parser.values("severity"), true);
+        filter.pids = SplitValues(parser.values("pid"));
+        filter.tids = SplitValues(parser.values("tid"));
+        if (!ParseTime(parser, "from", filter.start) || !ParseTime(parser, "to", filter.end))
+            return 2;
+
+        HighlightOptions highlightOpts;
+        if (parser.isSet("highlight") && !ReadHighlightFilters(parser.value("highlight"), highlightOpts))
+            return 2;
+
+        // Folders and zip archives show the path under them in the File column, like a log tree tab
+        QStringList files;
+        QStringList fileNames;
+        for (const QString& arg : parser.positionalArguments())
+        {
+            QFileInfo info(arg);
+            if (info.isDir() || (info.isFile() && ZipArchive::IsZip(arg)))
+            {
+                QDir root(info.absoluteFilePath());
+                for (const QString& file : LogTree::FindFiles(root.path(), parser.value("include")))
+                {
+                    files.append(file);
+                    fileNames.append(root.relativeFilePath(file));
+                }
+            }
+            else if (info.isFile())
+            {
+                files.append(info.absoluteFilePath());
+                fileNames.append(info.fileName());
+            }
+            else
+            {
+                Err() << QString("\"%1\" does not exist\n").arg(arg);
+                return 2;
+            }
+        }
+        if (files.isEmpty())
+        {
+            Err() << "No log to read\n";
+            return 2;
+        }
+
+        // JSON lines that only need the load filter are streamed straight from the logs
+        const int fileCount = static_cast<int>(files.size());
+        const LoadFilter* loadFilter = filter.IsActive() ? &filter : nullptr;
+        const bool needsModel = format != "jsonl" || !highlightOpts.isEmpty() || parser.isSet("find");
+        if (!needsModel)
+        {
+            qint64 writtenCount = 0;
+            int skippedCount = 0;
+            if (!StreamJsonLines(files, fileNames, loadFilter, parser.value("output"), nullptr, writtenCount, skippedCount))
+                return 1;
+            Err() << QString("%1 events read from %2 files; %3 events skipped\n")
+                     .arg(writtenCount).arg(fileCount).arg(skippedCount);
+            return 0;
+        }
+
+        // Each file is read on its own core, then the files are merged on time
+        std::vector<EventListPtr> fileEvents(fileCount);
+        std::vector<int> skippedCounts(fileCount, 0);
+        ParallelUtils::ForRanges(fileCount, [&](int first, int last) {
+            for (int i = first; i < last; i++)
+            {
+                fileEvents[i] = LogReader::ReadEvents(files[i], skippedCounts[i], nullptr, fileNames[i], loadFilter);
+            }
+        }, 1);
+        // Files of different folders can have the same name, so kept events are traced back by file index
+        std::vector<int> eventFiles;
+        auto events = std::make_shared<EventList>(LogTree::MergeByTime(fileEvents, &eventFiles));
+        fileEvents.clear();
+
+        TreeModel model(LogTab::ColumnHeaders(), events);
+        if (!highlightOpts.isEmpty())
+            KeepMatchingRows(&model, highlightOpts);
+        if (parser.isSet("find"))
+        {
+            SearchOpt findOpt;
+            findOpt.m_value = parser.value("find");
+            findOpt.m_keys = {COL::Value};
+            HighlightOptions findOpts;
+            findOpts.append(findOpt);
+            KeepMatchingRows(&model, findOpts);
+        }
+
+        int skippedCount = std::accumulate(skippedCounts.begin(), skippedCounts.end(), 0);
+        Err() << QString("%1 events read from %2 files; %3 events skipped; %4 events kept\n")
+                 .arg(events->size()).arg(fileCount).arg(skippedCount)
+                 .arg(model.rowCount() - model.HiddenRowCount());
+        Err().flush();
+
+        if (format == "jsonl")
+        {
+            // The kept events are written as the lines they were read from, with their keys in the
+            // order of the log and without the fields added while loading
+            // The model is never sorted, so its rows are in the order of the merged events
+            std::vector<std::vector<bool>> keptLines(fileCount);
+            for (int row = 0; row < model.rowCount(); row++)
+            {
+                if (model.IsHiddenRow(row))
+                    continue;
+                QJsonObject event = model.GetEvent(model.index(row, 0));
+                std::vector<bool>& kept = keptLines[eventFiles[row]];
+                const int index = event["idx"].toInt();
+                if (index >= static_cast<int>(kept.size()))
+                    kept.resize(index + 1, false);
+                kept[index] = true;
+            }
+            qint64 writtenCount = 0;
+            int streamSkippedCount = 0;
+            return StreamJsonLines(files, fileNames, loadFilter, parser.value("output"), &keptLines,
+                                   writtenCount, streamSkippedCount) ? 0 : 1;
+        }
+
+        if (format == "summary")
+        {
+            QTextStream out(stdout);
+            out << Reports::Summary(&model) << "\n";
+            return 0;
+        }
+
+        std::vector<Reports::CsvFile> csvFiles = Reports::QueryCsvFiles(&model);
+        if (csvFiles.empty())
+        {
+            Err() << "No event with an elapsed time to write\n";
+            return 1;
+        }
+        QString folder = parser.isSet("output") ? parser.value("output") : PathHelper::GetDocumentsPath() + "/TLV";
+        QString error;
+        if (!Reports::SaveCsvFiles(csvFiles, folder, error))
+        {
+            Err() << error << "\n";
+            return 1;
+        }
+        Err() << QString("CSV files written to \"%1\"\n").arg(QDir(folder).absolutePath());
+        return 0;
+    }
+}
+
+namespace BatchMode
+{
+    bool IsRequested(int argc, char *argv[])
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            if (std::strcmp(argv[i], "--query") == 0)
+                return true;
+        }
+        return false;
+    }
+
+    int Run(QCoreApplication& app)
+    {
+        QCommandLineParser parser;
+        parser.setApplicationDescription("Reads Tableau logs and writes the events that pass the filters.");
+        parser.addHelpOption();
+        parser.addVersionOption();
+        parser.addOptions({
+            {"query", "Run without a window."},
+            {"format", "Output format: jsonl (default), summary or csv.", "format", "jsonl"},
+            {"output", "File of the JSON lines (default: standard output), or folder of the CSV files "
+                       "(default: TLV in the documents folder).", "path"},
+            {"include", "Globs of the files to read in folders and zip archives (default: \"*.txt *.log *.gz *.zst\").", "globs", "*.txt *.log *.gz *.zst"},
+            {"key", "Keep only events with these keys.", "keys"},
+            {"exclude-key", "Drop events with these keys.", "keys"},
+            {"severity", "Keep only events with these severities.", "severities"},
+            {"pid", "Keep only events of these process ids.", "pids"},
+            {"tid", "Keep only events of these thread ids.", "tids"},
+            {"from", "Keep only events at or after this time.", "time"},
+            {"to", "Keep only events at or before this time.", "time"},
+            {"highlight", "Keep only events that match a highlight filter file, or a saved filter.", "filters"},
+            {"find", "Keep only events whose value contains this text.", "text"},
+            {"trace", "Record the time taken by each phase into a Chrome trace JSON file.", "file"},
+        });
+        parser.addPositionalArgument("paths", "Log files, or folders to read the matching files of.", "paths...");
+        parser.process(app);
+
+        if (parser.isSet("trace"))
+            Trace::SetRecording(true);
+
+        int exitCode = RunQuery(parser);
+
+        QString error;
+        if (parser.isSet("trace") && !Trace::Save(parser.value("trace"), error))
+        {
+            Err() << QString("Cannot write the trace \"%1\": %2\n").arg(parser.value("trace"), error);
+            return exitCode == 0 ? 1 : exitCode;
+        }
+        return exitCode;
+    }
+}
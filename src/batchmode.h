@@ -0,0 +1,19 @@
+#ifndef BATCHMODE_H
+#define BATCHMODE_H
+
+#include <QCoreApplication>
+
+// Running a query on logs from the command line, without showing a window:
+//   tlv --query [--format jsonl|summary|csv] [--output path] [filters] files or folders...
+// It can also record a trace of its phases with --trace file.
+// Files are read with the same parser, skip list and filters as the tabs, so the output matches
+// what a tab would show.
+namespace BatchMode
+{
+    // True when the command line asks for the batch mode
+    bool IsRequested(int argc, char *argv[]);
+    // Runs the query and returns the exit code of the process
+    int Run(QCoreApplication& app);
+}
+
+#endif // BATCHMODE_H
@@ -0,0 +1,82 @@
+#include "columnindex.h"
+
+#include <algorithm>
+#include <iterator>
+
+bool ColumnIndex::IsIndexed(COL column)
+{
+    switch (column)
+    {
+        case COL::File:
+        case COL::PID:
+        case COL::TID:
+        case COL::Severity:
+        case COL::Request:
+        case COL::Session:
+        case COL::Site:
+        case COL::User:
+        case COL::Key:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool ColumnIndex::IsBuilt() const
+{
+    return m_built;
+}
+
+void ColumnIndex::SetBuilt()
+{
+    m_built = true;
+}
+
+void ColumnIndex::Clear()
+{
+    m_rows.clear();
+    m_built = false;
+}
+
+void ColumnIndex::Add(const QString& value, int row)
+{
+    m_rows[value].push_back(row);
+}
+
+const ColumnIndex::RowList& ColumnIndex::Rows(const QString& value) const
+{
+    static const RowList NoRows;
+    auto rows = m_rows.find(value);
+    return (rows != m_rows.end()) ? rows.value() : NoRows;
+}
+
+ColumnIndex::RowList ColumnIndex::Rows(const QSet<QString>& values) const
+{
+    RowList result;
+    for (const QString& value : values)
+    {
+        const RowList& rows = Rows(value);
+        RowList merged;
+        merged.reserve(result.size() + rows.size());
+        std::merge(result.begin(), result.end(), rows.begin(), rows.end(), std::back_inserter(merged));
+        result.swap(merged);
+    }
+    return result;
+}
+
+QList<QString> ColumnIndex::Values() const
+{
+    return m_rows.keys();
+}
+
+qint64 ColumnIndex::MemoryBytes() const
+{
+    // A hash node holds the key, the row list and a next pointer
+    const qint64 NodeSize = sizeof(QString) + sizeof(RowList) + sizeof(void*);
+    qint64 bytes = 0;
+    for (auto iter = m_rows.constBegin(); iter != m_rows.constEnd(); ++iter)
+    {
+        bytes += NodeSize + iter.key().size() * sizeof(QChar) + iter.value().capacity() * sizeof(int);
+    }
+    return bytes;
+}
@@ -0,0 +1,36 @@
+#ifndef COLUMNINDEX_H
+#define COLUMNINDEX_H
+
+#include "column.h"
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <vector>
+
+// Inverted index of a column: maps every value of the column to the sorted list of
+// top-level rows holding it. Meant for the fixed columns with few distinct values
+// (key, session, thread...), where looking up a value is much cheaper than a scan.
+class ColumnIndex
+{
+public:
+    typedef std::vector<int> RowList;
+
+    static bool IsIndexed(COL column);
+
+    bool IsBuilt() const;
+    void SetBuilt();
+    void Clear();
+    // Rows must be added in increasing order to keep the row lists sorted
+    void Add(const QString& value, int row);
+    const RowList& Rows(const QString& value) const;
+    RowList Rows(const QSet<QString>& values) const;
+    QList<QString> Values() const;
+    qint64 MemoryBytes() const;
+
+private:
+    QHash<QString, RowList> m_rows;
+    bool m_built = false;
+};
+
+#endif // COLUMNINDEX_H
@@ -0,0 +1,356 @@
+#include "compressedfile.h"
+
+#include "ziparchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <QDebug>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#if __has_include(<zlib.h>)
+#include <zlib.h>
+#else
+#include <QtZlib/zlib.h>
+#endif
+
+#ifdef TLV_ZSTD
+#include <zstd.h>
+#endif
+
+namespace
+{
+    const int ChunkSize = 1 << 20;
+    // Chunks decompressed ahead of the reader, which bounds the memory of the pipeline
+    const int MaxQueuedChunks = 8;
+    const quint16 ZipStored = 0;
+}
+
+CompressedFile::CompressedFile(const QString& path)
+    : m_path(path)
+{
+}
+
+CompressedFile::~CompressedFile()
+{
+    close();
+}
+
+CompressedFile::Format CompressedFile::GetFormat(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        QString zipPath;
+        QString name;
+        return ZipArchive::SplitMemberPath(path, zipPath, name) ? Format::ZipMember : Format::None;
+    }
+
+    QByteArray magic = file.read(4);
+    if (magic.size() >= 2 && uchar(magic[0]) == 0x1f && uchar(magic[1]) == 0x8b)
+        return Format::Gzip;
+    if (magic == QByteArray("\x28\xb5\x2f\xfd", 4))
+        return Format::Zstd;
+    return Format::None;
+}
+
+bool CompressedFile::IsCompressed(const QString& path)
+{
+    return GetFormat(path) != Format::None;
+}
+
+bool CompressedFile::open(OpenMode mode)
+{
+    if (isOpen() || (mode & QIODevice::WriteOnly))
+        return false;
+
+    m_format = GetFormat(m_path);
+    m_inputOffset = 0;
+    m_inputSize = -1;
+    if (m_format == Format::None)
+    {
+        setErrorString(QString("Cannot read %1").arg(m_path));
+        return false;
+    }
+#ifndef TLV_ZSTD
+    if (m_format == Format::Zstd)
+    {
+        setErrorString(QString("Cannot read %1, this build does not read zstd").arg(m_path));
+        return false;
+    }
+#endif
+    if (m_format == Format::ZipMember)
+    {
+        QString zipPath;
+        QString name;
+        ZipArchive::Member member;
+        if (!ZipArchive::SplitMemberPath(m_path, zipPath, name) || !ZipArchive::FindMember(zipPath, name, member) ||
+            (m_inputOffset = ZipArchive::DataOffset(zipPath, member)) < 0)
+        {
+            setErrorString(QString("Cannot find %1").arg(m_path));
+            return false;
+        }
+        m_inputSize = member.compressedSize;
+        m_zipMethod = member.method;
+    }
+
+    m_chunks.clear();
+    m_chunkOffset = 0;
+    m_queuedBytes = 0;
+    m_isFinished = false;
+    m_isStopping = false;
+    if (!QIODevice::open(mode))
+        return false;
+
+    m_decompressor = QThread::create([this]() { Decompress(); });
+    m_decompressor->start();
+    return true;
+}
+
+void CompressedFile::close()
+{
+    if (m_decompressor)
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_isStopping = true;
+            m_chunkTaken.wakeAll();
+        }
+        m_decompressor->wait();
+        delete m_decompressor;
+        m_decompressor = nullptr;
+    }
+
+    m_chunks.clear();
+    m_chunkOffset = 0;
+    m_queuedBytes = 0;
+    QIODevice::close();
+}
+
+bool CompressedFile::isSequential() const
+{
+    return true;
+}
+
+bool CompressedFile::atEnd() const
+{
+    if (!isOpen())
+        return true;
+    if (QIODevice::bytesAvailable() > 0)
+        return false;
+
+    // Not at the end while the decompressor may still produce data, reading waits for it
+    QMutexLocker locker(&m_mutex);
+    return m_chunks.isEmpty() && m_isFinished;
+}
+
+qint64 CompressedFile::bytesAvailable() const
+{
+    QMutexLocker locker(&m_mutex);
+    return QIODevice::bytesAvailable() + m_queuedBytes;
+}
+
+qint64 CompressedFile::readData(char* data, qint64 maxSize)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_chunks.isEmpty() && !m_isFinished)
+    {
+        m_chunkReady.wait(&m_mutex);
+    }
+
+    qint64 copied = 0;
+    while (copied < maxSize && !m_chunks.isEmpty())
+    {
+        const QByteArray& chunk = m_chunks.head();
+        qint64 count = std::min(maxSize - copied, chunk.size() - m_chunkOffset);
+        std::memcpy(data + copied, chunk.constData() + m_chunkOffset, count);
+        copied += count;
+        m_chunkOffset += count;
+        if (m_chunkOffset == chunk.size())
+        {
+            m_chunks.dequeue();
+            m_chunkOffset = 0;
+            m_chunkTaken.wakeAll();
+        }
+    }
+    m_queuedBytes -= copied;
+    return copied;
+}
+
+qint64 CompressedFile::writeData(const char* /* data */, qint64 /* maxSize */)
+{
+    return -1;
+}
+
+/// <summary>
+/// Runs on the pipeline thread. Reads the compressed data and queues the decompressed chunks,
+/// waiting while the reader is MaxQueuedChunks behind.
+/// </summary>
+void CompressedFile::Decompress()
+{
+    QString path = m_path;
+    if (m_format == Format::ZipMember)
+    {
+        QString name;
+        ZipArchive::SplitMemberPath(m_path, path, name);
+    }
+
+    QFile file(path);
+    if (file.open(QIODevice::ReadOnly) && file.seek(m_inputOffset))
+    {
+        switch (m_format)
+        {
+            case Format::Gzip:
+                // 16 selects the gzip wrapper
+                Inflate(file, m_inputSize, MAX_WBITS + 16);
+                break;
+            case Format::Zstd:
+                DecompressZstd(file);
+                break;
+            case Format::ZipMember:
+                // Zip members are raw deflate streams, which a negative window selects
+                if (m_zipMethod == ZipStored)
+                    CopyStored(file, m_inputSize);
+                else
+                    Inflate(file, m_inputSize, -MAX_WBITS);
+                break;
+            case Format::None:
+                break;
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_isFinished = true;
+    m_chunkReady.wakeAll();
+}
+
+bool CompressedFile::Inflate(QFile& file, qint64 inputSize, int windowBits)
+{
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, windowBits) != Z_OK)
+        return false;
+
+    bool isOk = true;
+    QByteArray input;
+    // A full output chunk may leave more output for the same input
+    bool isOutputFull = false;
+    while (isOk)
+    {
+        if (stream.avail_in == 0 && !isOutputFull)
+        {
+            input = ReadInput(file, inputSize);
+            if (input.isEmpty())
+                break;
+            stream.next_in = reinterpret_cast<Bytef*>(input.data());
+            stream.avail_in = static_cast<uInt>(input.size());
+        }
+
+        QByteArray output(ChunkSize, Qt::Uninitialized);
+        stream.next_out = reinterpret_cast<Bytef*>(output.data());
+        stream.avail_out = ChunkSize;
+        int result = inflate(&stream, Z_NO_FLUSH);
+        if (result == Z_STREAM_END)
+        {
+            // Appending to a .gz adds another member, which continues the same text
+            inflateReset(&stream);
+        }
+        else if (result != Z_OK && result != Z_BUF_ERROR)
+        {
+            qWarning() << "Cannot inflate" << m_path << (stream.msg ? stream.msg : "");
+            isOk = false;
+        }
+
+        isOutputFull = stream.avail_out == 0;
+        output.truncate(ChunkSize - stream.avail_out);
+        if (!output.isEmpty() && !Enqueue(output))
+            break;
+    }
+
+    inflateEnd(&stream);
+    return isOk;
+}
+
+bool CompressedFile::DecompressZstd(QFile& file)
+{
+#ifdef TLV_ZSTD
+    ZSTD_DStream* stream = ZSTD_createDStream();
+    if (!stream)
+        return false;
+
+    // Frames that follow each other are decompressed as one text, like gzip members
+    bool isOk = true;
+    qint64 inputLeft = -1;
+    QByteArray input;
+    ZSTD_inBuffer in = {nullptr, 0, 0};
+    bool isOutputFull = false;
+    while (isOk)
+    {
+        if (in.pos == in.size && !isOutputFull)
+        {
+            input = ReadInput(file, inputLeft);
+            if (input.isEmpty())
+                break;
+            in = {input.constData(), static_cast<size_t>(input.size()), 0};
+        }
+
+        QByteArray output(ChunkSize, Qt::Uninitialized);
+        ZSTD_outBuffer out = {output.data(), static_cast<size_t>(ChunkSize), 0};
+        size_t result = ZSTD_decompressStream(stream, &out, &in);
+        if (ZSTD_isError(result))
+        {
+            qWarning() << "Cannot decompress" << m_path << ZSTD_getErrorName(result);
+            isOk = false;
+        }
+
+        isOutputFull = out.pos == out.size;
+        output.truncate(static_cast<qsizetype>(out.pos));
+        if (!output.isEmpty() && !Enqueue(output))
+            break;
+    }
+
+    ZSTD_freeDStream(stream);
+    return isOk;
+#else
+    Q_UNUSED(file);
+    return false;
+#endif
+}
+
+bool CompressedFile::CopyStored(QFile& file, qint64 inputSize)
+{
+    while (true)
+    {
+        QByteArray output = ReadInput(file, inputSize);
+        if (output.isEmpty())
+            return true;
+        if (!Enqueue(output))
+            return false;
+    }
+}
+
+QByteArray CompressedFile::ReadInput(QFile& file, qint64& inputLeft)
+{
+    if (inputLeft == 0)
+        return QByteArray();
+
+    QByteArray input = file.read(inputLeft < 0 ? ChunkSize : std::min<qint64>(inputLeft, ChunkSize));
+    if (inputLeft > 0)
+        inputLeft -= input.size();
+    return input;
+}
+
+bool CompressedFile::Enqueue(const QByteArray& output)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_chunks.size() >= MaxQueuedChunks && !m_isStopping)
+    {
+        m_chunkTaken.wait(&m_mutex);
+    }
+    if (m_isStopping)
+        return false;
+    m_queuedBytes += output.size();
+    m_chunks.enqueue(output);
+    m_chunkReady.wakeAll();
+    return true;
+}
@@ -0,0 +1,72 @@
+#ifndef COMPRESSEDFILE_H
+#define COMPRESSEDFILE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QIODevice>
+#include <QMutex>
+#include <QQueue>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+// Read-only device over a compressed log, so it can be read line by line without unpacking it
+// to disk first. Reads gzip and zstd files, and the members of zip archives named by
+// ZipArchive::MemberPath. The file is decompressed on a pipeline thread a few chunks ahead of
+// the reader, which overlaps decompression with parsing.
+class CompressedFile : public QIODevice
+{
+public:
+    enum class Format
+    {
+        None,
+        Gzip,
+        Zstd,
+        ZipMember
+    };
+
+    explicit CompressedFile(const QString& path);
+    ~CompressedFile();
+
+    // Gzip and zstd are told by their magic bytes, whatever the extension
+    static Format GetFormat(const QString& path);
+    static bool IsCompressed(const QString& path);
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override;
+    bool atEnd() const override;
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    void Decompress();
+    bool Inflate(QFile& file, qint64 inputSize, int windowBits);
+    bool DecompressZstd(QFile& file);
+    bool CopyStored(QFile& file, qint64 inputSize);
+    // Reads the next input chunk, at most inputLeft bytes of it when that is not negative
+    QByteArray ReadInput(QFile& file, qint64& inputLeft);
+    // Queues a decompressed chunk for the reader. False when the device is closing.
+    bool Enqueue(const QByteArray& output);
+
+    QString m_path;
+    Format m_format = Format::None;
+    // Where the compressed data starts in the file and how long it is, -1 for all of it
+    qint64 m_inputOffset = 0;
+    qint64 m_inputSize = -1;
+    quint16 m_zipMethod = 0;
+    QThread* m_decompressor = nullptr;
+    mutable QMutex m_mutex;
+    QWaitCondition m_chunkReady;
+    QWaitCondition m_chunkTaken;
+    QQueue<QByteArray> m_chunks;
+    qint64 m_chunkOffset = 0;
+    qint64 m_queuedBytes = 0;
+    bool m_isFinished = false;
+    bool m_isStopping = false;
+};
+
+#endif // COMPRESSEDFILE_H
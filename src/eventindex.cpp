@@ -0,0 +1,163 @@
+#include "eventindex.h"
+
+#include "indexcache.h"
+#include "options.h"
+#include "parallelutils.h"
+#include "processevent.h"
+#include "trace.h"
+
+#include <atomic>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace
+{
+    const quint32 Magic = 0x544C5649; // "TLVI"
+    const quint32 Version = 2;
+
+    QString IndexPath(const QString& logPath)
+    {
+        return IndexCache::IndexPath(logPath, "tlvidx");
+    }
+
+    // Hash of the options that ProcessLogEventMessage reads, which decide what a line turns into
+    QByteArray OptionsSignature()
+    {
+        Options& options = Options::GetInstance();
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream << options.getSkippedText() << options.getSkippedState()
+               << options.getElapsedKeys() << options.getElapsedMsKeys();
+        return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    }
+
+    bool ReadEntries(const QString& logPath, const QFileInfo& logInfo, std::vector<EventIndex::Entry>& entries, int& skippedCount, int& lineCount)
+    {
+        QFile file(IndexPath(logPath));
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+
+        QDataStream stream(&file);
+        quint32 magic = 0;
+        quint32 version = 0;
+        stream >> magic >> version;
+        if (magic != Magic || version != Version)
+            return false;
+
+        qint64 size = 0;
+        qint64 modified = 0;
+        QByteArray signature;
+        qint32 skipped = 0;
+        qint32 lines = 0;
+        quint32 count = 0;
+        stream >> size >> modified >> signature >> skipped >> lines >> count;
+        if (stream.status() != QDataStream::Ok ||
+            size != logInfo.size() ||
+            modified != logInfo.lastModified().toMSecsSinceEpoch() ||
+            signature != OptionsSignature() ||
+            count > static_cast<quint64>(size))
+        {
+            return false;
+        }
+
+        entries.resize(count);
+        for (auto& entry : entries)
+        {
+            stream >> entry.offset >> entry.length >> entry.index;
+            if (entry.offset < 0 || entry.length < 0 || entry.offset + entry.length > size)
+                return false;
+        }
+        if (stream.status() != QDataStream::Ok)
+            return false;
+
+        file.close();
+        IndexCache::Touch(file.fileName());
+        skippedCount = skipped;
+        lineCount = lines;
+        return true;
+    }
+}
+
+namespace EventIndex
+{
+    bool LoadEvents(const QString& logPath, const QString& fileName, QList<QJsonObject>& events,
+                    int& skippedCount, int& lineCount)
+    {
+        Trace::Scope scope("LoadIndexedEvents", logPath);
+        QFileInfo logInfo(logPath);
+        std::vector<Entry> entries;
+        int skipped = 0;
+        int lines = 0;
+        if (!ReadEntries(logPath, logInfo, entries, skipped, lines))
+            return false;
+
+        QFile logFile(logPath);
+        if (!logFile.open(QIODevice::ReadOnly))
+            return false;
+        uchar* data = logFile.map(0, logFile.size());
+        if (!data)
+            return false;
+
+        // The lines are independent, so each thread parses its own range straight from the mapping
+        const int count = static_cast<int>(entries.size());
+        QList<QJsonObject> parsed(count);
+        QJsonObject* out = parsed.data();
+        std::atomic<bool> isComplete{true};
+        ParallelUtils::ForRanges(count, [&](int first, int last) {
+            for (int i = first; i < last; i++)
+            {
+                const Entry& entry = entries[i];
+                QByteArray line = QByteArray::fromRawData(reinterpret_cast<const char*>(data) + entry.offset, entry.length).trimmed();
+                out[i] = ProcessEvent::ProcessLogEventMessage(entry.index, QString::fromUtf8(line), fileName);
+                if (out[i].isEmpty())
+                    isComplete = false;
+            }
+        }, 256);
+        logFile.unmap(data);
+
+        // Only lines that became events are indexed, so this means the index is stale
+        if (!isComplete)
+            return false;
+
+        events = std::move(parsed);
+        skippedCount += skipped;
+        lineCount = lines;
+        return true;
+    }
+
+    bool LoadEntries(const QString& logPath, std::vector<Entry>& entries, int& skippedCount, int& lineCount)
+    {
+        return ReadEntries(logPath, QFileInfo(logPath), entries, skippedCount, lineCount);
+    }
+
+    void Save(const QString& logPath, const std::vector<Entry>& entries, int skippedCount, int lineCount)
+    {
+        QFileInfo logInfo(logPath);
+        QDir().mkpath(QFileInfo(IndexPath(logPath)).absolutePath());
+        QSaveFile file(IndexPath(logPath));
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            qWarning() << "Cannot write the index of" << logPath;
+            return;
+        }
+
+        QDataStream stream(&file);
+        stream << Magic << Version
+               << logInfo.size() << logInfo.lastModified().toMSecsSinceEpoch()
+               << OptionsSignature()
+               << static_cast<qint32>(skippedCount) << static_cast<qint32>(lineCount)
+               << static_cast<quint32>(entries.size());
+        for (const auto& entry : entries)
+        {
+            stream << entry.offset << entry.length << entry.index;
+        }
+        if (file.commit())
+            IndexCache::Prune();
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef EVENTINDEX_H
+#define EVENTINDEX_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <vector>
+
+// Sidecar index of a log file, kept in the config directory. It records where the lines that
+// became events start, so reopening an unchanged log skips reading it line by line and parses
+// the events on all cores straight from a mapping of the file.
+namespace EventIndex
+{
+    // Smaller logs are parsed quickly enough that an index isn't worth the disk space
+    const qint64 MinFileSize = 32 * 1024 * 1024;
+
+    struct Entry
+    {
+        qint64 offset;
+        qint32 length;
+        // Value of "idx" of the event, its line number among the non-empty lines
+        qint32 index;
+    };
+
+    // Fills events from the index of logPath. Returns false when there is no index, or when the
+    // file or the options that decide how lines become events changed since it was written.
+    // lineCount is set to the number of non-empty lines of the file.
+    bool LoadEvents(const QString& logPath, const QString& fileName, QList<QJsonObject>& events,
+                    int& skippedCount, int& lineCount);
+    // Where the events of logPath are, without reading them. Same conditions as LoadEvents.
+    bool LoadEntries(const QString& logPath, std::vector<Entry>& entries, int& skippedCount, int& lineCount);
+    void Save(const QString& logPath, const std::vector<Entry>& entries, int skippedCount, int lineCount);
+}
+
+#endif // EVENTINDEX_H
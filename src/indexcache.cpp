@@ -0,0 +1,63 @@
+#include "indexcache.h"
+
+#include "pathhelper.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+namespace
+{
+    QFileInfoList IndexFiles()
+    {
+        QDir dir(PathHelper::GetIndexConfigPath());
+        // Most recently used first
+        return dir.entryInfoList({"*.tlvidx", "*.tlvtime"}, QDir::Files, QDir::Time);
+    }
+}
+
+namespace IndexCache
+{
+    QString IndexPath(const QString& logPath, const QString& extension)
+    {
+        QByteArray key = QFileInfo(logPath).absoluteFilePath().toUtf8();
+        QString name = QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex();
+        return PathHelper::GetIndexConfigPath() + "/" + name + "." + extension;
+    }
+
+    void Touch(const QString& indexPath)
+    {
+        // Indexes check the size and time of the log, not their own, so the time is free to track use
+        QFile file(indexPath);
+        if (file.open(QIODevice::ReadWrite))
+            file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+
+    void Prune()
+    {
+        const QDateTime expiry = QDateTime::currentDateTime().addDays(-MaxAgeDays);
+        qint64 totalSize = 0;
+        for (const QFileInfo& info : IndexFiles())
+        {
+            if (info.lastModified() < expiry || totalSize + info.size() > MaxTotalSize)
+            {
+                QFile::remove(info.absoluteFilePath());
+                continue;
+            }
+            totalSize += info.size();
+        }
+    }
+
+    qint64 Clear()
+    {
+        qint64 freedBytes = 0;
+        for (const QFileInfo& info : IndexFiles())
+        {
+            if (QFile::remove(info.absoluteFilePath()))
+                freedBytes += info.size();
+        }
+        return freedBytes;
+    }
+}
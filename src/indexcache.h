@@ -0,0 +1,24 @@
+#ifndef INDEXCACHE_H
+#define INDEXCACHE_H
+
+#include <QString>
+
+// The index directory in the config directory, shared by the event and time indexes. Files are
+// named by a hash of the log path, so indexes of moved or deleted logs are never read again;
+// they expire after a while and the directory is kept under a total size, least recently used first.
+namespace IndexCache
+{
+    const qint64 MaxTotalSize = 2LL * 1024 * 1024 * 1024;
+    const int MaxAgeDays = 30;
+
+    // Where the index of logPath with the given extension is, e.g. "tlvidx"
+    QString IndexPath(const QString& logPath, const QString& extension);
+    // Marks an index as used, so it is the last to be evicted
+    void Touch(const QString& indexPath);
+    // Removes expired indexes, then the least recently used ones until the directory fits MaxTotalSize
+    void Prune();
+    // Removes every index. Returns the number of bytes freed.
+    qint64 Clear();
+}
+
+#endif // INDEXCACHE_H
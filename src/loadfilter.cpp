@@ -0,0 +1,106 @@
+#include "loadfilter.h"
+
+#include "timeutils.h"
+
+#include <QStringList>
+#include <QStringView>
+
+namespace
+{
+    // Value of the first "key" of a JSON log line, without the quotes of a string. Tableau logs
+    // write "v" last, so the first match is the top-level field. Null when there is no such field.
+    QStringView RawValue(const QString& line, QLatin1String quotedKey)
+    {
+        qsizetype pos = line.indexOf(quotedKey);
+        if (pos < 0)
+            return QStringView();
+
+        pos += quotedKey.size();
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == ':'))
+        {
+            pos++;
+        }
+        if (pos >= line.size())
+            return QStringView();
+
+        if (line[pos] == '"')
+        {
+            qsizetype close = line.indexOf('"', pos + 1);
+            if (close < 0)
+                return QStringView();
+            return QStringView(line).mid(pos + 1, close - pos - 1);
+        }
+        qsizetype end = pos;
+        while (end < line.size() && line[end] != ',' && line[end] != '}' && line[end] != ' ')
+        {
+            end++;
+        }
+        return QStringView(line).mid(pos, end - pos);
+    }
+
+    bool IsKept(const QSet<QString>& values, QStringView value)
+    {
+        return values.isEmpty() || values.contains(value.toString());
+    }
+
+    QString JoinSorted(const QSet<QString>& values)
+    {
+        QStringList list = values.values();
+        list.sort();
+        return list.join(", ");
+    }
+}
+
+bool LoadFilter::IsActive() const
+{
+    return !includeKeys.isEmpty() || !excludeKeys.isEmpty() || !severities.isEmpty() ||
+           !pids.isEmpty() || !tids.isEmpty() ||
+           start != std::numeric_limits<qint64>::min() || end != std::numeric_limits<qint64>::max();
+}
+
+bool LoadFilter::Rejects(const QString& line) const
+{
+    // Lines that aren't JSON have an empty key and none of the other fields
+    const bool isJson = line.startsWith('{');
+    if (!includeKeys.isEmpty() || !excludeKeys.isEmpty())
+    {
+        QString key = isJson ? RawValue(line, QLatin1String("\"k\"")).toString() : QString("");
+        if (!IsKept(includeKeys, key) || excludeKeys.contains(key))
+            return true;
+    }
+    if (!severities.isEmpty() && !(isJson && IsKept(severities, RawValue(line, QLatin1String("\"sev\"")).toString().toLower())))
+        return true;
+    if (!pids.isEmpty() && !(isJson && IsKept(pids, RawValue(line, QLatin1String("\"pid\"")))))
+        return true;
+    if (!tids.isEmpty() && !(isJson && IsKept(tids, RawValue(line, QLatin1String("\"tid\"")))))
+        return true;
+
+    if (start != std::numeric_limits<qint64>::min() || end != std::numeric_limits<qint64>::max())
+    {
+        qint64 time;
+        if (!isJson || !TimeUtils::ParseTimestamp(RawValue(line, QLatin1String("\"ts\"")).toString(), time) ||
+            time < start || time > end)
+            return true;
+    }
+    return false;
+}
+
+QString LoadFilter::ToString() const
+{
+    QStringList parts;
+    if (!includeKeys.isEmpty())
+        parts.append(QString("Keys: %1").arg(JoinSorted(includeKeys)));
+    if (!excludeKeys.isEmpty())
+        parts.append(QString("Excluded keys: %1").arg(JoinSorted(excludeKeys)));
+    if (!severities.isEmpty())
+        parts.append(QString("Severities: %1").arg(JoinSorted(severities)));
+    if (!pids.isEmpty())
+        parts.append(QString("PIDs: %1").arg(JoinSorted(pids)));
+    if (!tids.isEmpty())
+        parts.append(QString("TIDs: %1").arg(JoinSorted(tids)));
+    if (start != std::numeric_limits<qint64>::min())
+        parts.append(QString("From: %1").arg(TimeUtils::FormatDateTime(start)));
+    if (end != std::numeric_limits<qint64>::max())
+        parts.append(QString("To: %1").arg(TimeUtils::FormatDateTime(end)));
+    return parts.join("\n");
+}
@@ -0,0 +1,28 @@
+#ifndef LOADFILTER_H
+#define LOADFILTER_H
+
+#include <limits>
+#include <QSet>
+#include <QString>
+
+// Events to keep while a log is read. The rest are dropped from the raw line before it is parsed,
+// so they never cost parse time or memory. Empty sets keep every value.
+struct LoadFilter
+{
+    QSet<QString> includeKeys;
+    QSet<QString> excludeKeys;
+    // Lower case, as "sev" is matched without case
+    QSet<QString> severities;
+    QSet<QString> pids;
+    QSet<QString> tids;
+    // Microseconds since the epoch
+    qint64 start = std::numeric_limits<qint64>::min();
+    qint64 end = std::numeric_limits<qint64>::max();
+
+    bool IsActive() const;
+    // True when the event of a raw log line doesn't pass the filter
+    bool Rejects(const QString& line) const;
+    QString ToString() const;
+};
+
+#endif // LOADFILTER_H
@@ -0,0 +1,83 @@
+#include "loadfilterdlg.h"
+#include "ui_loadfilterdlg.h"
+
+#include "timeutils.h"
+
+#include <QMessageBox>
+#include <QRegularExpression>
+
+static QSet<QString> SplitValues(const QString& text, bool isLowerCase = false)
+{
+    QSet<QString> values;
+    static const QRegularExpression separators("[,\\s]+");
+    for (const QString& value : text.split(separators, Qt::SkipEmptyParts))
+    {
+        values.insert(isLowerCase ? value.toLower() : value);
+    }
+    return values;
+}
+
+static QString JoinValues(const QSet<QString>& values)
+{
+    QStringList list = values.values();
+    list.sort();
+    return list.join(", ");
+}
+
+// An empty time leaves that end of the window open
+static bool ParseTime(const QString& text, qint64& usecs)
+{
+    return text.trimmed().isEmpty() || TimeUtils::ParseTimestamp(text.trimmed(), usecs);
+}
+
+static QString FormatTime(qint64 usecs, qint64 unset)
+{
+    if (usecs == unset)
+        return QString();
+    return TimeUtils::ToDateTime(usecs).toString("yyyy-MM-ddTHH:mm:ss.zzz");
+}
+
+LoadFilterDlg::LoadFilterDlg(QWidget *parent, const LoadFilter& filter) :
+    QDialog(parent),
+    ui(new Ui::LoadFilterDlg)
+{
+    ui->setupUi(this);
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    ui->includeKeysEdit->setText(JoinValues(filter.includeKeys));
+    ui->excludeKeysEdit->setText(JoinValues(filter.excludeKeys));
+    ui->severitiesEdit->setText(JoinValues(filter.severities));
+    ui->pidsEdit->setText(JoinValues(filter.pids));
+    ui->tidsEdit->setText(JoinValues(filter.tids));
+    ui->fromEdit->setText(FormatTime(filter.start, std::numeric_limits<qint64>::min()));
+    ui->toEdit->setText(FormatTime(filter.end, std::numeric_limits<qint64>::max()));
+}
+
+LoadFilterDlg::~LoadFilterDlg()
+{
+    delete ui;
+}
+
+LoadFilter LoadFilterDlg::GetFilter() const
+{
+    LoadFilter filter;
+    filter.includeKeys = SplitValues(ui->includeKeysEdit->text());
+    filter.excludeKeys = SplitValues(ui->excludeKeysEdit->text());
+    filter.severities = SplitValues(ui->severitiesEdit->text(), true);
+    filter.pids = SplitValues(ui->pidsEdit->text());
+    filter.tids = SplitValues(ui->tidsEdit->text());
+    ParseTime(ui->fromEdit->text(), filter.start);
+    ParseTime(ui->toEdit->text(), filter.end);
+    return filter;
+}
+
+void LoadFilterDlg::on_buttonBox_accepted()
+{
+    qint64 time;
+    if (!ParseTime(ui->fromEdit->text(), time) || !ParseTime(ui->toEdit->text(), time))
+    {
+        QMessageBox::warning(this, tr("Invalid time"), tr("Times are written like 2024-01-31T13:45:00.000"));
+        return;
+    }
+    accept();
+}
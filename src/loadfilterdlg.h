@@ -0,0 +1,29 @@
+#ifndef LOADFILTERDLG_H
+#define LOADFILTERDLG_H
+
+#include "loadfilter.h"
+
+#include <QDialog>
+
+namespace Ui {
+class LoadFilterDlg;
+}
+
+class LoadFilterDlg : public QDialog
+{
+    Q_OBJECT
+
+public:
+    LoadFilterDlg(QWidget *parent, const LoadFilter& filter);
+    ~LoadFilterDlg();
+
+    LoadFilter GetFilter() const;
+
+private slots:
+    void on_buttonBox_accepted();
+
+private:
+    Ui::LoadFilterDlg *ui;
+};
+
+#endif // LOADFILTERDLG_H
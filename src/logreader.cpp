@@ -0,0 +1,160 @@
+#include "logreader.h"
+
+#include "eventindex.h"
+#include "compressedfile.h"
+#include "options.h"
+#include "processevent.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+
+namespace
+{
+    // Bytes at the start of a log that tell it apart from a rewritten file on refresh
+    const qint64 LogHeadSize = 4096;
+
+    QByteArray HashLogHead(QFile& file, qint64 headSize)
+    {
+        if (!file.seek(0))
+            return QByteArray();
+        return QCryptographicHash::hash(file.read(headSize), QCryptographicHash::Sha1);
+    }
+
+    // A last line without a newline that is cut off JSON, most likely because it is still being written
+    bool IsPartialLine(const QByteArray& rawLine, const QByteArray& line)
+    {
+        if (rawLine.endsWith('\n') || !line.startsWith('{'))
+            return false;
+        QJsonParseError error;
+        QJsonDocument::fromJson(line, &error);
+        return error.error != QJsonParseError::NoError;
+    }
+
+    // Parses the lines of device into events. With indexEntries, records where each event's line is.
+    // With stopAtPartialLine, a partial last line is left unread, with the device positioned at its
+    // start, so a refresh reads it once it is complete instead of skipping it.
+    void ReadLogLines(QIODevice& device, const QString& fileName, EventList& events, int& eventCount,
+                      int& skippedCount, std::vector<EventIndex::Entry>* indexEntries, const LoadFilter* filter,
+                      bool stopAtPartialLine = false)
+    {
+        while (!device.atEnd())
+        {
+            qint64 offset = device.pos();
+            QByteArray rawLine;
+            QByteArray line;
+            {
+                Trace::SummedScope scope("SplitLine");
+                rawLine = device.readLine();
+                line = rawLine.trimmed();
+            }
+            if (line.isEmpty())
+            {
+                continue;
+            }
+            if (stopAtPartialLine && device.atEnd() && IsPartialLine(rawLine, line))
+            {
+                device.seek(offset);
+                break;
+            }
+            QJsonObject ev = ProcessEvent::ProcessLogEventMessage(++eventCount, line, fileName, filter);
+            if (!ev.isEmpty())
+            {
+                events.append(ev);
+                if (indexEntries)
+                    indexEntries->push_back({offset, static_cast<qint32>(rawLine.size()), eventCount});
+            }
+            else
+            {
+                skippedCount++;
+            }
+        }
+    }
+}
+
+namespace LogReader
+{
+    bool IsAppendedTo(const QString& path, const FileReadState& state)
+    {
+        QFile file(path);
+        if (state.size == 0 || !file.open(QIODevice::ReadOnly) || file.size() < state.size)
+            return false;
+        return HashLogHead(file, state.headSize) == state.headHash;
+    }
+
+    EventListPtr ReadEvents(const QString& path, int& skippedCount, FileReadState* readState,
+                            const QString& fileName, const LoadFilter* filter)
+    {
+        auto events = std::make_shared<EventList>();
+        QFile logfile(path);
+        QFileInfo logfileinfo(path);
+        const QString displayName = fileName.isEmpty() ? logfileinfo.fileName() : fileName;
+        Trace::Scope scope("ReadEvents", path);
+
+        // Compressed logs and zip members are decompressed while they are parsed. Offsets into the
+        // decompressed text mean nothing to the index or to a refresh, so they are always read whole.
+        if (CompressedFile::IsCompressed(path))
+        {
+            CompressedFile compressedFile(path);
+            if (compressedFile.open(QIODevice::ReadOnly))
+            {
+                int eventCount = 0;
+                ReadLogLines(compressedFile, displayName, *events, eventCount, skippedCount, nullptr, filter);
+            }
+            else
+            {
+                qWarning() << compressedFile.errorString();
+            }
+            return events;
+        }
+
+        const bool isTail = readState && readState->size > 0;
+        int eventCount = isTail ? readState->lineCount : 0;
+        int fileSkippedCount = 0;
+
+        // Reopening an unchanged large log goes straight to the lines its index points at.
+        // The index only has the events of an unfiltered read.
+        bool useIndex = !isTail && Options::GetInstance().getIndexLargeLogs() && logfileinfo.size() >= EventIndex::MinFileSize &&
+                        !(filter && filter->IsActive());
+        bool isIndexed = useIndex && EventIndex::LoadEvents(path, displayName, *events, fileSkippedCount, eventCount);
+
+        if (logfile.open(QIODevice::ReadOnly))
+        {
+            qint64 endOffset = logfile.size();
+            if (!isIndexed)
+            {
+                std::vector<EventIndex::Entry> indexEntries;
+                if (isTail)
+                    logfile.seek(readState->size);
+
+                // A refresh reads on from endOffset, so a line still being written is read whole next time
+                ReadLogLines(logfile, displayName, *events, eventCount, fileSkippedCount,
+                             useIndex ? &indexEntries : nullptr, filter, readState != nullptr);
+                endOffset = logfile.pos();
+
+                // The index must cover the whole file, as it is only checked against the file's size
+                if (useIndex && endOffset == logfile.size())
+                    EventIndex::Save(path, indexEntries, fileSkippedCount, eventCount);
+            }
+
+            if (readState)
+            {
+                if (!isTail)
+                {
+                    readState->headSize = std::min(endOffset, LogHeadSize);
+                    readState->headHash = HashLogHead(logfile, readState->headSize);
+                }
+                readState->size = endOffset;
+                readState->lineCount = eventCount;
+                readState->eventCount += static_cast<int>(events->size());
+            }
+            logfile.close();
+        }
+        skippedCount += fileSkippedCount;
+        return events;
+    }
+}
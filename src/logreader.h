@@ -0,0 +1,24 @@
+#ifndef LOGREADER_H
+#define LOGREADER_H
+
+#include "loadfilter.h"
+#include "treemodel.h"
+
+#include <QString>
+
+// Reading the events of log files, shared by the tabs and the batch mode
+namespace LogReader
+{
+    // Reads the events of a log file. With a read state that already has data, only the lines appended
+    // after it are read. The read state is updated to the end of the file.
+    // The File column shows fileName, or the name of the file when it is empty.
+    // Events the filter rejects are counted as skipped.
+    // Only reads the file and the options, so different files can be read from different threads.
+    EventListPtr ReadEvents(const QString& path, int& skippedCount, FileReadState* readState = nullptr,
+                            const QString& fileName = QString(), const LoadFilter* filter = nullptr);
+
+    // True when the file still starts with what was read from it, and is at least as long
+    bool IsAppendedTo(const QString& path, const FileReadState& state);
+}
+
+#endif // LOGREADER_H
@@ -1,28 +1,46 @@
 #include "logtab.h"
 #include "ui_logtab.h"
 
+#include "compressedfile.h"
 #include "options.h"
 #include "pathhelper.h"
 #include "processevent.h"
 #include "themeutils.h"
+#include "timeutils.h"
+#include "trace.h"
 #include "treeitem.h"
 #include "valuedlg.h"
 
+#include <algorithm>
 #include <memory>
 #include <initializer_list>
 #include <QSet>
 #include <QFontDatabase>
+#include <QInputDialog>
+#include <QLocale>
 #include <QMenu>
 #include <QJsonDocument>
 
-LogTab::LogTab(QWidget *parent, StatusBar *bar, const EventListPtr events) :
+LogTab::LogTab(QWidget *parent, StatusBar *bar, const EventListPtr events, std::vector<int> rows) :
     QWidget(parent),
     ui(new Ui::LogTab),
     m_bar(bar)
 {
     ui->setupUi(this);
     setFocusProxy(ui->treeView);
-    InitTreeView(events);
+    // The parent of the model is this widget. The model will get destroyed when the widget is destroyed
+    InitTreeView(new TreeModel(ColumnHeaders(), events, std::move(rows), this));
+    InitMenus();
+}
+
+LogTab::LogTab(QWidget *parent, StatusBar *bar, const PagedEventsPtr events, std::vector<int> rows) :
+    QWidget(parent),
+    ui(new Ui::LogTab),
+    m_bar(bar)
+{
+    ui->setupUi(this);
+    setFocusProxy(ui->treeView);
+    InitTreeView(new TreeModel(ColumnHeaders(), events, std::move(rows), this));
     InitMenus();
 }
 
@@ -31,29 +49,41 @@ LogTab::~LogTab()
     delete ui;
 }
 
-void LogTab::InitTreeView(const EventListPtr events)
+QStringList LogTab::ColumnHeaders()
 {
-    ui->treeView->setSelectionMode(QAbstractItemView::SelectionMode::ExtendedSelection);
+    return QString("ID;File;Time;Elapsed;PID;TID;Severity;Request;Session;Site;User;Key;ART;Error Code;Value").split(";");
+}
 
-    QStringList headers = QString("ID;File;Time;Elapsed;PID;TID;Severity;Request;Session;Site;User;Key;ART;Error Code;Value").split(";");
+void LogTab::InitTreeView(TreeModel* model)
+{
+    ui->treeView->setSelectionMode(QAbstractItemView::SelectionMode::ExtendedSelection);
 
-    // The parent of the model is this widget. The model will get destroyed when the widget is destroyed
-    m_treeModel = new TreeModel(headers, events, this);
+    m_treeModel = model;
     ui->treeView->setModel(m_treeModel);
 
+    // Sort on header clicks, starting from the original order
+    ui->treeView->header()->setSortIndicator(-1, Qt::AscendingOrder);
+    ui->treeView->setSortingEnabled(true);
+    connect(m_treeModel, &QAbstractItemModel::layoutChanged, this, [this]() {
+        // New events put the model back in the original order
+        if (!m_treeModel->IsSorted() && ui->treeView->header()->sortIndicatorSection() != -1)
+            ui->treeView->header()->setSortIndicator(-1, Qt::AscendingOrder);
+    });
+
     m_bar->ShowMessage(QString("%1 events loaded").arg(QString::number(m_treeModel->rowCount())), 3000);
 
     // Display only time if all events occured on the same day
     bool multipleDays = false;
-    if (events->size() >= 2) {
+    if (m_treeModel->rowCount() >= 2) {
        QModelIndex idx = ui->treeView->currentIndex();
-       auto firstDatetime = m_treeModel->index(0, COL::Time, idx.parent()).data(Qt::UserRole).toDateTime();
-       auto lastDatetime = m_treeModel->index(m_treeModel->rowCount()-1, COL::Time, idx.parent()).data(Qt::UserRole).toDateTime();
-       multipleDays = firstDatetime.date() != lastDatetime.date();
+       auto firstUsecs = m_treeModel->index(0, COL::Time, idx.parent()).data(Qt::UserRole);
+       auto lastUsecs = m_treeModel->index(m_treeModel->rowCount()-1, COL::Time, idx.parent()).data(Qt::UserRole);
+       multipleDays = firstUsecs.isValid() && lastUsecs.isValid() &&
+           TimeUtils::ToDateTime(firstUsecs.toLongLong()).date() != TimeUtils::ToDateTime(lastUsecs.toLongLong()).date();
     }
     m_treeModel->SetTimeMode(multipleDays ? TimeMode::GlobalDateTime : TimeMode::GlobalTime);
 
-    bool hasNoKey = (events->size() > 0 && events->at(0)["k"].toString().isEmpty());
+    bool hasNoKey = (m_treeModel->rowCount() > 0 && m_treeModel->GetEvent(m_treeModel->index(0, 0))["k"].toString().isEmpty());
 
     SetColumn(COL::ID, 80, false);
     SetColumn(COL::File, 110, true);
@@ -99,6 +129,13 @@ void LogTab::InitMenus()
     m_hideSelectedType = new QAction(QIcon(GetThemedIcon(":/ctx-hide.png")), "Hide all events of this type", this);
     connect(m_hideSelectedType, &QAction::triggered, this, &LogTab::RowHideSelectedType);
 
+    m_undoHideAction = new QAction(QIcon(GetThemedIcon(":/ctx-refresh.png")), "Undo hide", this);
+    m_undoHideAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_Z));
+    connect(m_undoHideAction, &QAction::triggered, this, &LogTab::RowUndoHide);
+
+    m_showHiddenAction = new QAction(QIcon(GetThemedIcon(":/ctx-refresh.png")), "Show all hidden events", this);
+    connect(m_showHiddenAction, &QAction::triggered, this, &LogTab::RowShowHidden);
+
     // The columns available in the `Highlight` and `Export` submenus
     std::initializer_list<std::pair<const char*,COL>> availableFilterColumns{
         {"This type",COL::Key},
@@ -160,6 +197,8 @@ void LogTab::InitTwoRowsMenu()
                              this, &LogTab::RowDiffEvents, QKeySequence(Qt::CTRL | Qt::Key_D));
     m_twoRowsMenu->addAction(m_hideSelectedEvent);
     m_twoRowsMenu->addAction(m_hideSelectedType);
+    m_twoRowsMenu->addAction(m_undoHideAction);
+    m_twoRowsMenu->addAction(m_showHiddenAction);
     m_twoRowsMenu->addSeparator();
     m_twoRowsMenu->addAction(m_highlightSelectedType);
     m_twoRowsMenu->addMenu(m_highlightSelectedMenu);
@@ -177,6 +216,8 @@ void LogTab::InitMultipleRowsMenu()
     m_multipleRowsMenu = new QMenu(this);
     m_multipleRowsMenu->addAction(m_hideSelectedEvent);
     m_multipleRowsMenu->addAction(m_hideSelectedType);
+    m_multipleRowsMenu->addAction(m_undoHideAction);
+    m_multipleRowsMenu->addAction(m_showHiddenAction);
     m_multipleRowsMenu->addSeparator();
     m_multipleRowsMenu->addAction(m_highlightSelectedType);
     m_multipleRowsMenu->addMenu(m_highlightSelectedMenu);
@@ -223,6 +264,8 @@ void LogTab::InitOneRowMenu()
     m_oneRowMenu = new QMenu(this);
     m_oneRowMenu->addAction(m_hideSelectedEvent);
     m_oneRowMenu->addAction(m_hideSelectedType);
+    m_oneRowMenu->addAction(m_undoHideAction);
+    m_oneRowMenu->addAction(m_showHiddenAction);
     m_oneRowMenu->addSeparator();
     m_oneRowMenu->addAction(findNextSelectedType);
     m_oneRowMenu->addAction(findPrevSelectedType);
@@ -268,6 +311,11 @@ void LogTab::keyPressEvent(QKeyEvent *event)
         {
             CopyItemDetailsAsHtml();
         }
+        else if ((event->key() == Qt::Key_Z) &&
+                 (QApplication::keyboardModifiers() & Qt::ControlModifier))
+        {
+            RowUndoHide();
+        }
         else if ((event->key() == Qt::Key_D) &&
                  (QApplication::keyboardModifiers() & Qt::ControlModifier) &&
                  (rowCount == 2))
@@ -413,7 +461,7 @@ void LogTab::ReadDirectoryFiles()
             {
                 continue;
             }
-            QJsonObject jsonObj = ProcessEvent::ProcessLogEventMessage(m_eventIndex, line, fileName);
+            QJsonObject jsonObj = ProcessEvent::ProcessLogEventMessage(m_eventIndex, line, fileName, &m_treeModel->m_loadFilter);
             if (jsonObj.isEmpty())
             {
                 continue;
@@ -429,13 +477,12 @@ void LogTab::ReadDirectoryFiles()
         int startRow = m_treeModel->MergeIntoModelData(newEvents);
         newEvents.clear();
 
-        if (m_treeModel->m_highlightOnlyMode)
+        if (m_treeModel->m_highlightOnlyMode || m_treeModel->HiddenRowCount() > 0)
         {
             const QModelIndex idx;
             for (int i = startRow; i < m_treeModel->rowCount(); i++)
             {
-                bool hidden = !m_treeModel->IsHighlightedRow(i);
-                ui->treeView->setRowHidden(i, idx, hidden);
+                ui->treeView->setRowHidden(i, idx, IsRowFilteredOut(i));
             }
         }
 
@@ -478,6 +525,13 @@ bool LogTab::StartFileLiveCapture()
         errorDialog.exec();
         return false;
     }
+    if (CompressedFile::IsCompressed(m_logFile.fileName()))
+    {
+        QErrorMessage errorDialog(this);
+        errorDialog.showMessage("Compressed files cannot be live captured");
+        errorDialog.exec();
+        return false;
+    }
     if (!m_logFile.open(QIODevice::ReadOnly | QIODevice::Text))
     {
         QErrorMessage errorDialog(this);
@@ -509,7 +563,7 @@ void LogTab::ReadFile()
         {
             continue;
         }
-        QJsonObject jsonObj = ProcessEvent::ProcessLogEventMessage(m_eventIndex, line, m_logFile.fileName());
+        QJsonObject jsonObj = ProcessEvent::ProcessLogEventMessage(m_eventIndex, line, m_logFile.fileName(), &m_treeModel->m_loadFilter);
         if (jsonObj.isEmpty())
         {
             continue;
@@ -519,8 +573,7 @@ void LogTab::ReadFile()
         newEvents.clear();
 
         int offset = m_treeModel->rowCount() - 1;
-        bool hidden = m_treeModel->m_highlightOnlyMode && !m_treeModel->IsHighlightedRow(offset);
-        ui->treeView->setRowHidden(offset, idx, hidden);
+        ui->treeView->setRowHidden(offset, idx, IsRowFilteredOut(offset));
 
         m_eventIndex++;
     }
@@ -616,12 +669,9 @@ void LogTab::ChangeNextIndex()
 {
     int row = ui->treeView->currentIndex().row() + 1;
     int column = ui->treeView->currentIndex().column();
-    if (m_treeModel->m_highlightOnlyMode)
+    while (row < m_treeModel->rowCount() && IsRowFilteredOut(row))
     {
-        while (!m_treeModel->IsHighlightedRow(row) && row < m_treeModel->rowCount())
-        {
-            row++;
-        }
+        row++;
     }
     if (row < m_treeModel->rowCount())
     {
@@ -635,12 +685,9 @@ void LogTab::ChangePrevIndex()
 {
     int row = ui->treeView->currentIndex().row() - 1;
     int column = ui->treeView->currentIndex().column();
-    if (m_treeModel->m_highlightOnlyMode)
+    while (row >= 0 && IsRowFilteredOut(row))
     {
-        while (!m_treeModel->IsHighlightedRow(row) && row >= 0)
-        {
-            row--;
-        }
+        row--;
     }
     if (row >= 0)
     {
@@ -789,13 +836,8 @@ void LogTab::CopyItemDetails(bool textOnly, bool normalized) const
 
 void LogTab::ExportToNewTab()
 {
+    // The export keeps the events in the order they occurred in, whatever order they were selected in
     auto idxList = ui->treeView->selectionModel()->selectedRows();
-    // Sort selected rows by row number to preserve the event ordering.
-    // The selection model saves them in the order they were clicked
-    // on, which might not be the same as the order that the events occurred in
-    std::sort(idxList.begin(), idxList.end(), [](QModelIndex a, QModelIndex b) {
-        return a.row() < b.row();
-    });
     emit exportToTab(idxList,"exported data");
 }
 
@@ -815,16 +857,12 @@ void LogTab::ExportToNewTab(COL column)
     QString name = QString(GetColumnName(column)) + " " + sortedValues.join(",");
 
     // Generate the index list
-    const int count = m_treeModel->rowCount();
     const QModelIndex root;
     QModelIndexList exportedIdxList;
-    for (int i = 0; i < count; ++i)
+    for (int row : m_treeModel->RowsWithValues(column, exportedValues))
     {
-        auto idx = m_treeModel->index(i, column, root);
-        auto value = idx.data().toString();
-        if (exportedValues.contains(value)) {
-            exportedIdxList.append(idx);
-        }
+        if (!m_treeModel->IsHiddenRow(row))
+            exportedIdxList.append(m_treeModel->index(row, column, root));
     }
 
     emit exportToTab(exportedIdxList, name);
@@ -847,13 +885,15 @@ void LogTab::RowRightClicked(const QPoint& pos)
     auto idxList =  ui->treeView->selectionModel()->selectedRows();
     auto rowCount = idxList.count();
     m_exportToTabAction->setEnabled(true);
+    m_undoHideAction->setEnabled(m_treeModel->CanUndoHide());
+    m_showHiddenAction->setEnabled(m_treeModel->HiddenRowCount() > 0);
     if (rowCount == 0)
     {
         m_exportToTabAction->setEnabled(false);
     }
     else if (rowCount == 1)
     {
-        bool isDirectoryTab = (m_treeModel->TabType() == TABTYPE::Directory);
+        bool isDirectoryTab = (m_treeModel->TabType() == TABTYPE::Directory || m_treeModel->TabType() == TABTYPE::LogTree);
         auto menuActions = m_oneRowMenu->actions();
         menuActions[m_openFileMenuIdx]->setVisible(isDirectoryTab);
 
@@ -930,72 +970,153 @@ void LogTab::RowDiffEvents()
     m_tempFiles.push_back(std::move(secondFile));
 }
 
+int LogTab::HideRows(const QVector<int>& rows)
+{
+    int count = m_treeModel->HideRows(rows);
+    if (count > 0)
+    {
+        ui->treeView->setUpdatesEnabled(false);
+        ui->treeView->selectionModel()->clearSelection();
+        const QModelIndex root;
+        for (int row : rows)
+        {
+            ui->treeView->setRowHidden(row, root, true);
+        }
+        ui->treeView->setUpdatesEnabled(true);
+    }
+    menuUpdateNeeded();
+    return count;
+}
+
 void LogTab::RowHideSelected()
 {
-    ui->treeView->setUpdatesEnabled(false);
     auto idxList = ui->treeView->selectionModel()->selectedRows();
-
-    // Sort the indices in reverse order. Remove the items from the
-    // end first to make sure indices stay valid after each removal
-    std::sort(idxList.rbegin(), idxList.rend());
-
+    QVector<int> rows;
     for (const auto& idx : idxList) {
-       m_treeModel->removeRow(idx.row(), idx.parent());
+       // Only whole events can be hidden, nested rows are part of their event
+       if (!idx.parent().isValid())
+           rows.append(idx.row());
+    }
+
+    int count = HideRows(rows);
+    if (count > 0) {
+        m_bar->ShowMessage(QString("%1 event(s) hidden. Press Ctrl+Z to undo").arg(QString::number(count)), 3000);
     }
-    ui->treeView->setUpdatesEnabled(true);
-    menuUpdateNeeded();
 }
 
 void LogTab::RowHideSelectedType()
 {
-    ui->treeView->setUpdatesEnabled(false);
     auto idxList = ui->treeView->selectionModel()->selectedRows();
     QSet<QString> hiddenKeys;
     for (const auto& idx : idxList) {
        QString key = idx.model()->index(idx.row(), COL::Key, idx.parent()).data().toString();
        hiddenKeys.insert(key);
     }
-    int count = 0;
-    for (const auto& key : hiddenKeys) {
-       auto match = m_treeModel->match(m_treeModel->index(0, COL::Key), Qt::DisplayRole, key, 1, Qt::MatchExactly);
-       while (match.length() > 0)
-       {
-           m_treeModel->removeRow(match[0].row());
-           match = m_treeModel->match(m_treeModel->index(match[0].row(), COL::Key), Qt::DisplayRole, key, 1, Qt::MatchExactly);
-           ++count;
-       }
+
+    QVector<int> rows;
+    for (int row : m_treeModel->RowsWithValues(COL::Key, hiddenKeys)) {
+       rows.append(row);
     }
-    ui->treeView->setUpdatesEnabled(true);
-    menuUpdateNeeded();
+    int count = HideRows(rows);
 
     if (hiddenKeys.count() == 1) {
         QString key = hiddenKeys.values()[0];
-        m_bar->ShowMessage(QString("%1 '%2' event(s) hidden").arg(QString::number(count), key), 3000);
+        m_bar->ShowMessage(QString("%1 '%2' event(s) hidden. Press Ctrl+Z to undo").arg(QString::number(count), key), 3000);
     } else {
-        m_bar->ShowMessage(QString("%1 event(s) of %2 types hidden").arg(QString::number(count), QString::number(hiddenKeys.count())), 3000);
+        m_bar->ShowMessage(QString("%1 event(s) of %2 types hidden. Press Ctrl+Z to undo").arg(QString::number(count), QString::number(hiddenKeys.count())), 3000);
     }
 }
 
-void LogTab::RowFindNextSelectedType()
+void LogTab::RowUndoHide()
 {
-    QModelIndex idx = ui->treeView->currentIndex();
+    std::vector<int> rows = m_treeModel->UndoHide();
+    if (rows.empty())
+        return;
 
-    m_treeModel->m_findOpts.m_keys.clear();
-    m_treeModel->m_findOpts.m_keys.append(COL::Key);
-    m_treeModel->m_findOpts.m_value = idx.model()->index(idx.row(), COL::Key, idx.parent()).data().toString();
-    RowFindNext();
+    ui->treeView->setUpdatesEnabled(false);
+    const QModelIndex root;
+    for (int row : rows)
+    {
+        ui->treeView->setRowHidden(row, root, IsRowFilteredOut(row));
+    }
+    ui->treeView->setUpdatesEnabled(true);
+    ui->treeView->scrollTo(m_treeModel->index(rows.front(), 0), QAbstractItemView::PositionAtCenter);
+    menuUpdateNeeded();
+    m_bar->ShowMessage(QString("%1 event(s) restored").arg(QString::number(static_cast<int>(rows.size()))), 3000);
+}
+
+void LogTab::RowShowHidden()
+{
+    int count = m_treeModel->UnhideAll();
+    if (count == 0)
+        return;
+
+    RefilterTreeView();
+    menuUpdateNeeded();
+    m_bar->ShowMessage(QString("%1 event(s) restored").arg(QString::number(count)), 3000);
+}
+
+bool LogTab::IsRowFilteredOut(int row) const
+{
+    return m_treeModel->IsHiddenRow(row) ||
+        (m_treeModel->m_highlightOnlyMode && !m_treeModel->IsHighlightedRow(row));
+}
+
+void LogTab::RowFindNextSelectedType()
+{
+    RowFindSelectedType(1);
     menuUpdateNeeded();
 }
 
 void LogTab::RowFindPrevSelectedType()
+{
+    RowFindSelectedType(-1);
+    menuUpdateNeeded();
+}
+
+void LogTab::RowFindSelectedType(int offset)
 {
     QModelIndex idx = ui->treeView->currentIndex();
+    QString key = idx.model()->index(idx.row(), COL::Key, idx.parent()).data().toString();
 
+    // Keep the find options in sync, so F3 continues with the same search
     m_treeModel->m_findOpts.m_keys.clear();
     m_treeModel->m_findOpts.m_keys.append(COL::Key);
-    m_treeModel->m_findOpts.m_value = idx.model()->index(idx.row(), COL::Key, idx.parent()).data().toString();
-    RowFindPrev();
-    menuUpdateNeeded();
+    m_treeModel->m_findOpts.m_value = key;
+    m_treeModel->m_findOpts.m_mode = SearchMode::Equals;
+    m_treeModel->m_findOpts.m_matchCase = true;
+
+    while (idx.parent().isValid())
+    {
+        idx = idx.parent();
+    }
+    const int start = idx.row();
+
+    // The rows are sorted, so the next or previous event of the type is found with a binary search
+    const auto& rows = m_treeModel->RowsWithValue(COL::Key, key);
+    const int count = static_cast<int>(rows.size());
+    int pos = (offset > 0) ?
+        static_cast<int>(std::upper_bound(rows.begin(), rows.end(), start) - rows.begin()) :
+        static_cast<int>(std::lower_bound(rows.begin(), rows.end(), start) - rows.begin()) - 1;
+
+    const QModelIndex root;
+    for (int i = 0; i < count; i++, pos += offset)
+    {
+        // Wrap around
+        pos = (pos + count) % count;
+        int row = rows[pos];
+        if (row == start)
+            break;
+        if (ui->treeView->isRowHidden(row, root))
+            continue;
+
+        ui->treeView->setCurrentIndex(m_treeModel->index(row, COL::Key));
+        m_bar->ShowMessage(QString("Found '%1' on line %2").arg(
+                               key,
+                               m_treeModel->data(m_treeModel->index(row, 0), Qt::DisplayRole).toString()), 3000);
+        return;
+    }
+    m_bar->ShowMessage(QString("Not found: '%1'").arg(key), 3000);
 }
 
 void LogTab::RowFindPrev()
@@ -1034,10 +1155,15 @@ void LogTab::RowFindImpl(int offset)
             return;
         }
 
+        if (ui->treeView->isRowHidden(i, QModelIndex()))
+            continue;
+
         foreach (int col, lstColumns)
         {
             QModelIndex idx = m_treeModel->index(i, col);
-            auto data = m_treeModel->data(idx, Qt::DisplayRole).toString();
+            QString data = (col == COL::Value) ?
+                m_treeModel->GetValueSearchString(idx) :
+                m_treeModel->data(idx, Qt::DisplayRole).toString();
             if (m_treeModel->m_findOpts.HasMatch(data))
             {
                 ui->treeView->setCurrentIndex(idx);
@@ -1092,18 +1218,39 @@ void LogTab::RowShowGlobalTime()
 void LogTab::RowShowTimeDeltas()
 {
     QModelIndex idx = ui->treeView->currentIndex();
-    auto datetime = idx.model()->index(idx.row(), COL::Time, idx.parent()).data(Qt::UserRole).toDateTime().toMSecsSinceEpoch();
-    m_treeModel->ShowDeltas(datetime);
+    auto usecs = idx.model()->index(idx.row(), COL::Time, idx.parent()).data(Qt::UserRole).toLongLong();
+    m_treeModel->ShowDeltas(usecs);
+}
+
+// Data of the header menu entries that are not columns
+namespace HeaderMenu
+{
+    const int ShowAll = -1;
+    const int AddPath = -2;
+    const int FilterPath = -3;
+    const int RemovePath = -4;
+    const int RestoreOrder = -5;
 }
 
 void LogTab::InitHeaderMenu()
 {
     m_headerMenu = new QMenu(this);
+    m_headerColumn = -1;
+
+    connect(m_headerMenu, SIGNAL(triggered(QAction*)),
+            this, SLOT(HeaderItemSelected(QAction*)), Qt::UniqueConnection);
+}
+
+void LogTab::PopulateHeaderMenu()
+{
+    // Path columns come and go, so the menu is rebuilt every time it is shown
+    m_headerMenu->clear();
     for (int i = 0; i < m_treeModel->columnCount(); i++)
     {
         QVariant hdata = m_treeModel->headerData(i, Qt::Horizontal, Qt::DisplayRole);
         QAction *action = new QAction(hdata.toString(), m_headerMenu);
         action->setCheckable(true);
+        action->setChecked(!ui->treeView->isColumnHidden(i));
         // Make some columns 'unhidable'
         if (i == COL::Value)
         {
@@ -1114,41 +1261,135 @@ void LogTab::InitHeaderMenu()
     }
 
     QAction *actionShowAll = new QAction("Show All", m_headerMenu);
-    actionShowAll->setData(-1);
+    actionShowAll->setData(HeaderMenu::ShowAll);
 
     m_headerMenu->addSeparator();
     m_headerMenu->addAction(actionShowAll);
 
-    connect(m_headerMenu, SIGNAL(triggered(QAction*)),
-            this, SLOT(HeaderItemSelected(QAction*)), Qt::UniqueConnection);
+    QAction *actionRestoreOrder = new QAction("Restore original order", m_headerMenu);
+    actionRestoreOrder->setData(HeaderMenu::RestoreOrder);
+    actionRestoreOrder->setEnabled(m_treeModel->IsSorted());
+    m_headerMenu->addAction(actionRestoreOrder);
+
+    m_headerMenu->addSeparator();
+    QAction *actionAddPath = new QAction("Add column from JSON path...", m_headerMenu);
+    actionAddPath->setData(HeaderMenu::AddPath);
+    m_headerMenu->addAction(actionAddPath);
+
+    if (const PathColumn* pathColumn = m_treeModel->GetPathColumn(m_headerColumn))
+    {
+        QAction *actionFilter = new QAction(QString("Hide events by '%1'...").arg(pathColumn->Path()), m_headerMenu);
+        actionFilter->setData(HeaderMenu::FilterPath);
+        m_headerMenu->addAction(actionFilter);
+
+        QAction *actionRemove = new QAction(QString("Remove column '%1'").arg(pathColumn->Path()), m_headerMenu);
+        actionRemove->setData(HeaderMenu::RemovePath);
+        m_headerMenu->addAction(actionRemove);
+    }
 }
 
 void LogTab::HeaderRightClicked(const QPoint &pos)
 {
-    for (int i = 0; i < m_treeModel->columnCount(); i++)
-    {
-        m_headerMenu->actions()[i]->setChecked(!ui->treeView->isColumnHidden(i));
-    }
+    m_headerColumn = ui->treeView->header()->logicalIndexAt(pos);
+    PopulateHeaderMenu();
     m_headerMenu->popup(ui->treeView->viewport()->mapToGlobal(pos));
 }
 
 void LogTab::HeaderItemSelected(QAction *action)
 {
     int column = action->data().toInt();
-    if (column == -1)
+    switch (column)
     {
-        // Show all columns
-        for (int i = 0; i < m_treeModel->columnCount(); i++)
+        case HeaderMenu::ShowAll:
+            // Show all columns
+            for (int i = 0; i < m_treeModel->columnCount(); i++)
+            {
+                ui->treeView->setColumnHidden(i, false);
+            }
+            break;
+        case HeaderMenu::AddPath:
+            AddPathColumnPrompt();
+            break;
+        case HeaderMenu::FilterPath:
+            FilterPathColumnPrompt(m_headerColumn);
+            break;
+        case HeaderMenu::RemovePath:
+            m_treeModel->RemovePathColumn(m_headerColumn);
+            break;
+        case HeaderMenu::RestoreOrder:
+            ui->treeView->sortByColumn(-1, Qt::AscendingOrder);
+            break;
+        default:
         {
-            ui->treeView->setColumnHidden(i, false);
+            // Toggle the column visibility
+            bool checkState = action->isChecked();
+            ui->treeView->setColumnHidden(column, !checkState);
+            break;
         }
     }
-    else
+}
+
+void LogTab::AddPathColumnPrompt()
+{
+    bool ok = false;
+    QString path = QInputDialog::getText(this, "Add column from JSON path",
+                                         "Path of the field in the event, e.g. v.elapsed, v.query-hash or a.res.alloc.v:",
+                                         QLineEdit::Normal, QString(), &ok).trimmed();
+    if (!ok || path.isEmpty())
+        return;
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    int column = AddPathColumn(path);
+    QApplication::restoreOverrideCursor();
+    ui->treeView->setColumnWidth(column, 100);
+}
+
+int LogTab::AddPathColumn(const QString& path)
+{
+    int column = m_treeModel->AddPathColumn(path);
+
+    // Keep the value as the last, stretched, column
+    QHeaderView* header = ui->treeView->header();
+    if (header->visualIndex(column) > header->visualIndex(COL::Value))
+    {
+        header->moveSection(header->visualIndex(column), header->visualIndex(COL::Value));
+    }
+    ui->treeView->setColumnHidden(column, false);
+    return column;
+}
+
+void LogTab::FilterPathColumnPrompt(int column)
+{
+    const PathColumn* pathColumn = m_treeModel->GetPathColumn(column);
+    if (!pathColumn)
+        return;
+
+    bool ok = false;
+    QString filterText = QInputDialog::getText(this, "Hide events",
+                                           QString("Keep the events where '%1' is, e.g. > 100, <= 2.5, = abc or != abc:").arg(pathColumn->Path()),
+                                           QLineEdit::Normal, QString(), &ok).trimmed();
+    if (!ok || filterText.isEmpty())
+        return;
+
+    PathColumn::Filter filter;
+    if (!PathColumn::ParseFilter(filterText, filter))
+    {
+        m_bar->ShowMessage(QString("Invalid filter: '%1'").arg(filterText), 3000);
+        return;
+    }
+
+    QVector<int> rows;
+    const int rowCount = pathColumn->RowCount();
+    for (int row = 0; row < rowCount; row++)
     {
-        // Toggle the column visibility
-        bool checkState = action->isChecked();
-        ui->treeView->setColumnHidden(column, !checkState);
+        if (!m_treeModel->IsHiddenRow(row) && !pathColumn->Matches(m_treeModel->StorageRow(row), filter))
+        {
+            rows.append(row);
+        }
     }
+
+    int count = HideRows(rows);
+    m_bar->ShowMessage(QString("%1 event(s) hidden. Press Ctrl+Z to undo").arg(QString::number(count)), 3000);
 }
 
 void LogTab::UpdateStatusBar()
@@ -1176,6 +1417,11 @@ void LogTab::UpdateStatusBar()
     }
 
     m_bar->SetRightLabelText(status);
+
+    // Sampled, as the status bar is updated on every action. Debug info counts everything.
+    MemoryUsage usage = m_treeModel->GetMemoryUsage(true);
+    m_bar->SetMemoryText(QLocale().formattedDataSize(usage.Total()),
+                         QString("Estimated memory of this tab:\n%1").arg(usage.ToString()));
 }
 
 QString LogTab::GetDebugInfo() const
@@ -1204,12 +1450,33 @@ QString LogTab::GetDebugInfo() const
     {
         tabType = "Exported Events";
     }
+    else if (m_treeModel->TabType() == TABTYPE::TimeRange)
+    {
+        tabType = "Time Range";
+        extra = QString("From: %1\nTo: %2\n").arg(TimeUtils::FormatDateTime(m_treeModel->m_rangeStart),
+                                                    TimeUtils::FormatDateTime(m_treeModel->m_rangeEnd));
+    }
+    else if (m_treeModel->TabType() == TABTYPE::LogTree)
+    {
+        tabType = "Log Tree";
+        extra = "Files:\n";
+        for (const QString& file : m_treeModel->m_paths)
+        {
+            extra += QString("    %1\n").arg(file);
+        }
+    }
 
+    if (m_treeModel->m_loadFilter.IsActive())
+    {
+        extra += QString("Load filter:\n%1\n").arg(m_treeModel->m_loadFilter.ToString());
+    }
+    extra += QString("Memory (estimated):\n%1\n").arg(m_treeModel->GetMemoryUsage().ToString());
     return QString("Type: %1\nPath: %2\n\n%3").arg(tabType).arg(m_tabPath).arg(extra);
 }
 
 void LogTab::RefilterTreeView()
 {
+    Trace::Scope scope("RefilterTreeView");
     QModelIndex previousIdx = ui->treeView->currentIndex();
 
     ui->treeView->setUpdatesEnabled(false);
@@ -1219,8 +1486,7 @@ void LogTab::RefilterTreeView()
 
     for (int i = 0; i < count; i++)
     {
-        bool hidden = m_treeModel->m_highlightOnlyMode && !m_treeModel->IsHighlightedRow(i);
-        ui->treeView->setRowHidden(i, idx, hidden);
+        ui->treeView->setRowHidden(i, idx, IsRowFilteredOut(i));
     }
 
     ui->treeView->setUpdatesEnabled(true);
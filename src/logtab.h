@@ -15,12 +15,16 @@ namespace Ui {
 class LogTab;
 }
 
+// Replaces ids, counts, times and temp paths in the text of events, so two similar events diff cleanly
+void NormalizeLogText(QString& logText);
+
 class LogTab : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit LogTab(QWidget *parent, StatusBar *bar, const EventListPtr events);
+    explicit LogTab(QWidget *parent, StatusBar *bar, const EventListPtr events, std::vector<int> rows = std::vector<int>());
+    explicit LogTab(QWidget *parent, StatusBar *bar, const PagedEventsPtr events, std::vector<int> rows = std::vector<int>());
     ~LogTab();
     bool StartLiveCapture();
     void EndLiveCapture();
@@ -30,18 +34,23 @@ public:
     void CopyFullPath();
     void ShowInFolder();
     void RefilterTreeView();
+    int AddPathColumn(const QString& path);
     TreeModel* GetTreeModel();
     QTreeView* GetTreeView();
+    static QStringList ColumnHeaders();
 
 private:
     void keyPressEvent(QKeyEvent *event) override;
 
-    void InitTreeView(const EventListPtr events);
+    void InitTreeView(TreeModel* model);
     void InitMenus();
     void InitOneRowMenu();
     void InitTwoRowsMenu();
     void InitMultipleRowsMenu();
     void InitHeaderMenu();
+    void PopulateHeaderMenu();
+    void AddPathColumnPrompt();
+    void FilterPathColumnPrompt(int column);
     void SetColumn(COL column, int width, bool isHidden);
     void ShowItemDetails(const QModelIndex&);
     void CopyItemDetails(bool textOnly, bool normalized) const;
@@ -51,6 +60,9 @@ private:
     void RowFindPrev();
     void RowFindNext();
     void RowFindImpl(int offset);
+    void RowFindSelectedType(int offset);
+    bool IsRowFilteredOut(int row) const;
+    int HideRows(const QVector<int>& rows);
     void ShowDetails(const QModelIndex& idx, ValueDlg& valueDlg);
     void ReadFile();
     void ReadDirectoryFiles();
@@ -69,10 +81,13 @@ private:
     QMenu *m_twoRowsMenu;
     QMenu *m_multipleRowsMenu;
     QMenu *m_headerMenu;
+    int m_headerColumn;
     ValueDlg *m_valueDlg;
     std::vector<std::unique_ptr<QTemporaryFile>> m_tempFiles;
     QAction *m_hideSelectedEvent;
     QAction *m_hideSelectedType;
+    QAction *m_undoHideAction;
+    QAction *m_showHiddenAction;
     QAction *m_highlightSelectedType;
     QMenu *m_highlightSelectedMenu;
     QMenu *m_exportToTabMenu;
@@ -98,6 +113,8 @@ private slots:
     void RowDiffEvents();
     void RowHideSelected();
     void RowHideSelectedType();
+    void RowUndoHide();
+    void RowShowHidden();
     void RowFindNextSelectedType();
     void RowFindPrevSelectedType();
     void RowHighlightSelected(COL column);
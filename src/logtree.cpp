@@ -0,0 +1,142 @@
+#include "logtree.h"
+
+#include "parallelutils.h"
+#include "timeutils.h"
+#include "ziparchive.h"
+
+#include <functional>
+#include <limits>
+#include <queue>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QRegularExpression>
+
+namespace
+{
+    struct Glob
+    {
+        QRegularExpression regex;
+        bool isPath;
+    };
+
+    bool MatchesAny(const std::vector<Glob>& globs, const QString& fileName, const QString& relativePath)
+    {
+        for (const auto& glob : globs)
+        {
+            if (glob.regex.match(glob.isPath ? relativePath : fileName).hasMatch())
+                return true;
+        }
+        return false;
+    }
+
+    // Events without a timestamp come first, like they do when merging a file into a tab
+    qint64 TimeKey(const QJsonObject& event)
+    {
+        qint64 usecs;
+        if (TimeUtils::ParseTimestamp(event["ts"].toString(), usecs))
+            return usecs;
+        return std::numeric_limits<qint64>::min();
+    }
+}
+
+namespace LogTree
+{
+    QStringList FindFiles(const QString& root, const QString& patterns)
+    {
+        std::vector<Glob> includes;
+        std::vector<Glob> excludes;
+        for (QString pattern : patterns.split(' ', Qt::SkipEmptyParts))
+        {
+            bool isExclude = pattern.startsWith('!');
+            if (isExclude)
+                pattern.remove(0, 1);
+            if (pattern.isEmpty())
+                continue;
+
+            Glob glob{QRegularExpression::fromWildcard(pattern, Qt::CaseInsensitive), pattern.contains('/')};
+            (isExclude ? excludes : includes).push_back(glob);
+        }
+
+        auto isMatch = [&includes, &excludes](const QString& fileName, const QString& relativePath) {
+            return (includes.empty() || MatchesAny(includes, fileName, relativePath)) &&
+                   !MatchesAny(excludes, fileName, relativePath);
+        };
+
+        QStringList files;
+        if (QFileInfo(root).isFile() && ZipArchive::IsZip(root))
+        {
+            for (const ZipArchive::Member& member : ZipArchive::ReadMembers(root))
+            {
+                if (isMatch(member.name.section('/', -1), member.name))
+                    files.append(ZipArchive::MemberPath(root, member.name));
+            }
+            files.sort();
+            return files;
+        }
+
+        QDir rootDir(root);
+        QDirIterator iter(root, QDir::Files, QDirIterator::Subdirectories);
+        while (iter.hasNext())
+        {
+            QString path = iter.next();
+            if (isMatch(iter.fileName(), rootDir.relativeFilePath(path)))
+                files.append(path);
+        }
+        files.sort();
+        return files;
+    }
+
+    EventList MergeByTime(const std::vector<EventListPtr>& lists, std::vector<int>* listIndexes)
+    {
+        const int listCount = static_cast<int>(lists.size());
+
+        // Timestamps of all the events, parsed a list per thread
+        std::vector<std::vector<qint64>> keys(listCount);
+        qsizetype total = 0;
+        for (int i = 0; i < listCount; i++)
+        {
+            keys[i].resize(lists[i]->size());
+            total += lists[i]->size();
+        }
+        ParallelUtils::ForRanges(listCount, [&lists, &keys](int first, int last) {
+            for (int i = first; i < last; i++)
+            {
+                for (int j = 0; j < static_cast<int>(keys[i].size()); j++)
+                {
+                    keys[i][j] = TimeKey(lists[i]->at(j));
+                }
+            }
+        }, 1);
+
+        // Next event of each list, earliest first and the first list on ties
+        typedef std::pair<qint64, int> Head;
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+        std::vector<int> positions(listCount, 0);
+        for (int i = 0; i < listCount; i++)
+        {
+            if (!keys[i].empty())
+                heads.emplace(keys[i][0], i);
+        }
+
+        EventList merged;
+        merged.reserve(total);
+        if (listIndexes)
+        {
+            listIndexes->clear();
+            listIndexes->reserve(total);
+        }
+        while (!heads.empty())
+        {
+            int list = heads.top().second;
+            heads.pop();
+            int& position = positions[list];
+            merged.append(lists[list]->at(position));
+            if (listIndexes)
+                listIndexes->push_back(list);
+            if (++position < static_cast<int>(keys[list].size()))
+                heads.emplace(keys[list][position], list);
+        }
+        return merged;
+    }
+}
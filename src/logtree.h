@@ -0,0 +1,25 @@
+#ifndef LOGTREE_H
+#define LOGTREE_H
+
+#include "treemodel.h"
+
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+// Opening a whole tree of logs at once, like an unpacked Tableau Server ziplogs bundle
+namespace LogTree
+{
+    // Files at any depth under root that match the patterns. Patterns are globs separated by spaces,
+    // and a glob starting with "!" excludes the files it matches. Globs with a "/" match the path
+    // relative to root, the others match the file name. When root is a zip archive, these are the
+    // paths of its members.
+    QStringList FindFiles(const QString& root, const QString& patterns);
+
+    // Merges event lists that are each in time order into a single list in time order.
+    // Events with equal timestamps keep the order of the lists. listIndexes, when given, gets the
+    // list each merged event came from.
+    EventList MergeByTime(const std::vector<EventListPtr>& lists, std::vector<int>* listIndexes = nullptr);
+}
+
+#endif // LOGTREE_H
@@ -1,16 +1,27 @@
 #include <QApplication>
 
+#include "batchmode.h"
 #include "mainwindow.h"
 
 int main(int argc, char *argv[])
 {
     Q_INIT_RESOURCE(resources);
 
+    bool isBatchMode = BatchMode::IsRequested(argc, argv);
+    if (isBatchMode)
+    {
+        // The model uses colors and fonts, but nothing is shown, so no display is needed
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
     QApplication app(argc, argv);
     app.setOrganizationName("Tableau");
     app.setApplicationName("TLV");
     app.setApplicationVersion(APP_VERSION);
 
+    if (isBatchMode)
+        return BatchMode::Run(app);
+
     std::unique_ptr<MainWindow> mainWin = std::make_unique<MainWindow>();
     mainWin->show();
     return app.exec();
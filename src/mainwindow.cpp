@@ -1,22 +1,35 @@
 #include "mainwindow.h"
 
 #include "finddlg.h"
+#include "compressedfile.h"
 #include "highlightdlg.h"
+#include "indexcache.h"
+#include "loadfilterdlg.h"
+#include "logreader.h"
 #include "logtab.h"
+#include "logtree.h"
 #include "options.h"
 #include "optionsdlg.h"
+#include "parallelutils.h"
 #include "pathhelper.h"
-#include "processevent.h"
+#include "reports.h"
 #include "savefilterdialog.h"
 #include "themeutils.h"
+#include "timeindex.h"
+#include "timerangedlg.h"
+#include "timeutils.h"
+#include "trace.h"
 #include "zoomabletreeview.h"
 
+#include <algorithm>
 #include <map>
+#include <numeric>
 
 #include <QApplication>
 #include <QDateTime>
 #include <QDebug>
 #include <QDialogButtonBox>
+#include <QDir>
 #include <QDragEnterEvent>
 #include <QFile>
 #include <QFileDialog>
@@ -26,6 +39,7 @@
 #include <QJsonObject>
 #include <QLabel>
 #include <QLineEdit>
+#include <QLocale>
 #include <QMessageBox>
 #include <QMimeData>
 #include <QScrollBar>
@@ -66,9 +80,28 @@ MainWindow::~MainWindow()
 {
 }
 
+// Recent log trees are kept as the root and the patterns they were opened with, separated by a tab
+static const QChar RecentLogTreeSeparator = '\t';
+
 void MainWindow::Recent_files_triggered(QAction * action)
 {
-    QString path = action->text();
+    QString path = action->data().isValid() ? action->data().toString() : action->text();
+    if (path.contains(RecentLogTreeSeparator))
+    {
+        QString rootPath = path.section(RecentLogTreeSeparator, 0, 0);
+        QString patterns = path.section(RecentLogTreeSeparator, 1);
+        if (QFileInfo::exists(rootPath))
+        {
+            OpenLogTree(rootPath, patterns);
+        }
+        else
+        {
+            RemoveRecentFile(path);
+            Ui_MainWindow::menuRecent_files->removeAction(action);
+        }
+        return;
+    }
+
     QFileInfo fi(path);
     if (fi.isDir())
     {
@@ -114,7 +147,7 @@ QString MainWindow::GetOpenDefaultFolder()
 
 QStringList MainWindow::PickLogFilesToOpen(QString caption)
 {
-    QFileDialog fileDlg(this, caption, GetOpenDefaultFolder(), "Log Files (*.txt *.log);;All Files (*)");
+    QFileDialog fileDlg(this, caption, GetOpenDefaultFolder(), "Log Files (*.txt *.log *.gz *.zst);;All Files (*)");
     fileDlg.setFileMode(QFileDialog::ExistingFiles);
     fileDlg.exec();
     m_lastOpenFolder = fileDlg.directory().absolutePath();
@@ -126,7 +159,13 @@ void MainWindow::UpdateRecentFilesMenu()
     ClearRecentFileMenu();
     for(const auto & path : m_recentFiles)
     {
-        Ui_MainWindow::menuRecent_files->addAction(path);
+        QAction* action = Ui_MainWindow::menuRecent_files->addAction(path);
+        if (path.contains(RecentLogTreeSeparator))
+        {
+            action->setText(QString("%1 (log tree: %2)").arg(path.section(RecentLogTreeSeparator, 0, 0),
+                                                             path.section(RecentLogTreeSeparator, 1)));
+            action->setData(path);
+        }
     }
 }
 
@@ -174,9 +213,11 @@ void MainWindow::UpdateMenuAndStatusBar()
     menuFind->setEnabled(logTab);
     // QActions
     // File
-    actionMerge_into_tab->setEnabled(logTab);
+    // Paged tabs keep their events in the file, so nothing is ever added to them
+    const bool isPaged = model && model->GetPagedEvents();
+    actionMerge_into_tab->setEnabled(logTab && !isPaged);
     actionClear_all_events->setEnabled(logTab);
-    actionRefresh->setEnabled(logTab);
+    actionRefresh->setEnabled(logTab && !isPaged);
     actionShow_summary->setEnabled(logTab);
     actionCreate_info_viz->setEnabled(logTab);
     actionClose_tab->setEnabled(logTab);
@@ -195,13 +236,14 @@ void MainWindow::UpdateMenuAndStatusBar()
     actionFind_next->setEnabled(hasFindOpts);
     actionFind_previous->setEnabled(hasFindOpts);
     //Live capture
-    actionTail_current_tab->setEnabled(model && model->TabType() != TABTYPE::ExportedEvents);
+    actionTail_current_tab->setEnabled(model && !isPaged && (model->TabType() == TABTYPE::SingleFile || model->TabType() == TABTYPE::Directory));
     actionTail_current_tab->setChecked(model && model->m_liveMode);
 
     // Status bar
     if (logTab == nullptr)
     {
         m_statusBar->SetRightLabelText("¯\\_(ツ)_/¯");
+        m_statusBar->SetMemoryText(QString(), QString());
         return;
     }
 
@@ -257,76 +299,69 @@ void MainWindow::ReadSettings()
     ZoomableTreeView::ReadSettings(settings);
 }
 
-EventListPtr MainWindow::GetEventsFromFile(QString path, int & skippedCount)
+void MainWindow::ExportEventsToTab(QModelIndexList list, QString name)
 {
-    auto events = std::make_shared<EventList>();
-    QFile logfile(path);
-    QFileInfo logfileinfo(path);
-
-    int eventCount = 0;
+    TreeModel * model = GetCurrentTreeModel();
+    QTreeView * view = GetCurrentTreeView();
 
-    if (logfile.open(QIODevice::ReadOnly))
+    // Mark the events of the selection in a single pass. A selected nested row exports its event,
+    // and an event is only exported once however many of its rows are selected.
+    const int sourceCount = model->rowCount();
+    std::vector<bool> isSelected(sourceCount, false);
+    std::vector<bool> isExpanded(sourceCount, false);
+    for (const QModelIndex& event : list)
     {
-        while (!logfile.atEnd())
+        QModelIndex topIdx = event;
+        while (topIdx.parent().isValid())
         {
-            auto line = logfile.readLine().trimmed();
-            if (line.isEmpty())
-            {
-                continue;
-            }
-            QJsonObject ev = ProcessEvent::ProcessLogEventMessage(++eventCount, line, logfileinfo.fileName());
-            if (!ev.isEmpty())
-            {
-                events->append(ev);
-            }
-            else
-            {
-                skippedCount++;
-            }
+            topIdx = topIdx.parent();
         }
-        logfile.close();
+        int row = model->StorageRow(topIdx.row());
+        if (row < 0 || row >= sourceCount)
+            continue;
+
+        isSelected[row] = true;
+        if (topIdx == event && view->isExpanded(event))
+            isExpanded[row] = true;
     }
-    return events;
-}
 
-void MainWindow::ExportEventsToTab(QModelIndexList list, QString name)
-{
-    auto events = std::make_shared<EventList>();
-    TreeModel * model = GetCurrentTreeModel();
-    QTreeView * view = GetCurrentTreeView();
-    for (QModelIndex event : list)
+    // The new tab shows rows of the events of the current tab instead of copying them,
+    // in the original order of the current tab
+    std::vector<int> rows;
+    std::vector<int> expandedRows;
+    for (int row = 0; row < sourceCount; row++)
     {
-        if (event.parent().row() == -1 || !list.contains(event.parent()))
-        {
-            QJsonObject jsonData = model->GetEvent(event);
-            events->append(jsonData);
-        }
+        if (!isSelected[row])
+            continue;
+        if (isExpanded[row])
+            expandedRows.push_back(static_cast<int>(rows.size()));
+        rows.push_back(model->StoreRow(row));
     }
+    if (rows.empty())
+        return;
 
-    LogTab * logTab = new LogTab(tabWidget, m_statusBar, events);
+    LogTab * logTab = model->GetPagedEvents()
+        ? new LogTab(tabWidget, m_statusBar, model->GetPagedEvents(), std::move(rows))
+        : new LogTab(tabWidget, m_statusBar, model->GetEventStore(), std::move(rows));
     QTreeView * exportedView = logTab->GetTreeView();
     TreeModel * exportedModel = logTab->GetTreeModel();
 
     exportedModel->SetTabType(TABTYPE::ExportedEvents);
     // Inherit highlight filters
     exportedModel->SetHighlightFilters(model->GetHighlightFilters());
+    // Inherit the JSON path columns
+    for (int column=COL::Value + 1; column<model->columnCount(); ++column) {
+       logTab->AddPathColumn(model->GetPathColumn(column)->Path());
+    }
     // Inherit the column layout
     for (int column=0; column<exportedModel->columnCount(); ++column) {
        exportedView->setColumnWidth(column, view->columnWidth(column));
        exportedView->setColumnHidden(column, view->isColumnHidden(column));
     }
     // Expand same items in exported view as in original view
-    int exportCount = 0;
-    for (QModelIndex event : list)
+    for (int row : expandedRows)
     {
-        if (event.parent().row() == -1)
-        {
-            QModelIndex exportIndex = exportedModel->index(exportCount, 0);
-            if (view->isExpanded(event))
-            {
-                exportedView->expand(exportIndex);
-            }
-        }
+        exportedView->expand(exportedModel->index(row, 0));
     }
 
     actionTail_current_tab->setEnabled(false);
@@ -381,7 +416,10 @@ void MainWindow::MergeLogFile(QString path)
         QMessageBox::warning(this, tr("Unable to open file"), tr("Unable to open file \"%1\"").arg(path));
         return;
     }
-    events = GetEventsFromFile(path, skippedCount);
+    // Merged files are read with the filter of the tab
+    TreeModel * model = GetCurrentTreeModel();
+    FileReadState readState;
+    events = LogReader::ReadEvents(path, skippedCount, &readState, QString(), &model->m_loadFilter);
 
     fileName = fi.fileName();
     filePath = fi.filePath();
@@ -391,9 +429,10 @@ void MainWindow::MergeLogFile(QString path)
     tabWidget->setTabText(currIdx, tabWidget->tabText(currIdx) + ", " + fileName);
 
     // Merge events in, add file name to model's paths
-    TreeModel * model = GetCurrentTreeModel();
-    model->MergeIntoModelData(*events);
+    if (!events->isEmpty())
+        model->MergeIntoModelData(*events);
     model->m_paths.append(filePath);
+    model->m_readStates[filePath] = readState;
 
     // Update status
     LogTab * logTab = GetCurrentLogTab();
@@ -446,6 +485,15 @@ inline QString SystemCase(const QString& path)
 }
 
 bool MainWindow::LoadLogFile(QString path)
+{
+    return LoadFilteredLogFile(path, LoadFilter());
+}
+
+/// <summary>
+/// Open a log file in a new tab with only the events that pass the filter. A filtered tab shows
+/// part of the file, so the file can still be opened whole next to it.
+/// </summary>
+bool MainWindow::LoadFilteredLogFile(QString path, const LoadFilter& filter)
 {
     EventListPtr events;
     QString fileName;
@@ -458,14 +506,42 @@ bool MainWindow::LoadLogFile(QString path)
         QMessageBox::warning(this, tr("Unable to open file"), tr("Unable to open file \"%1\"").arg(path));
         return false;
     }
-    events = GetEventsFromFile(path, skippedCount);
+    QString label = filter.IsActive() ? QString("%1 (filtered)").arg(fi.fileName()) : fi.fileName();
+
+    // Logs too large to load keep their events in the file, and are parsed as the rows are shown
+    const qint64 pagedLogSize = static_cast<qint64>(m_options.getPagedLogSize()) * 1024 * 1024;
+    if (pagedLogSize > 0 && fi.size() >= pagedLogSize && !CompressedFile::IsCompressed(path))
+    {
+        path.replace("\\", "/");
+        if (!filter.IsActive() && m_allFiles.contains(SystemCase(fi.filePath())))
+        {
+            FocusOpenedFile(path);
+            return true;
+        }
+
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        PagedEventsPtr pagedEvents = PagedEvents::Open(path, fi.fileName(), filter, skippedCount);
+        QApplication::restoreOverrideCursor();
+        if (pagedEvents)
+        {
+            SetUpTab(new LogTab(tabWidget, m_statusBar, pagedEvents), TABTYPE::SingleFile, path, label, filter);
+            statusBar()->showMessage(QString("%1 events paged in from the file; %2 events skipped")
+                                     .arg(QString::number(pagedEvents->Count()), QString::number(skippedCount)), 3000);
+            return true;
+        }
+        skippedCount = 0;
+    }
+
+    FileReadState readState;
+    events = LogReader::ReadEvents(path, skippedCount, &readState, QString(), &filter);
 
     fileName = fi.fileName();
     filePath = fi.filePath();
 	path.replace("\\", "/");
-    if (!m_allFiles.contains(SystemCase(filePath)))
+    if (filter.IsActive() || !m_allFiles.contains(SystemCase(filePath)))
     {
-        SetUpTab(events, false, path, fileName);
+        LogTab* logTab = SetUpTab(events, TABTYPE::SingleFile, path, label, filter);
+        logTab->GetTreeModel()->m_readStates[path] = readState;
     }
     else
     {
@@ -485,7 +561,7 @@ void MainWindow::StartDirectoryLiveCapture(QString directoryPath, QString label)
             label = QString("%1 directory").arg(fi.fileName());
         }
         EventListPtr events = std::make_shared<EventList>();
-        SetUpTab(events, true, directoryPath, label);
+        SetUpTab(events, TABTYPE::Directory, directoryPath, label);
     }
     else
     {
@@ -493,36 +569,49 @@ void MainWindow::StartDirectoryLiveCapture(QString directoryPath, QString label)
     }
 }
 
-LogTab* MainWindow::SetUpTab(EventListPtr events, bool isDirectory, QString path, QString label)
+// Tabs of a time range or of filtered events show part of their file, which can still be opened whole
+static bool ShowsWholeFiles(const TreeModel* model)
+{
+    return model->TabType() != TABTYPE::TimeRange && !model->m_loadFilter.IsActive();
+}
+
+LogTab* MainWindow::SetUpTab(EventListPtr events, TABTYPE type, QString path, QString label, const LoadFilter& filter)
+{
+    return SetUpTab(new LogTab(tabWidget, m_statusBar, events), type, path, label, filter);
+}
+
+LogTab* MainWindow::SetUpTab(LogTab* logTab, TABTYPE type, QString path, QString label, const LoadFilter& filter)
 {
-    LogTab * logTab = new LogTab(tabWidget, m_statusBar, events);
     connect(logTab, &LogTab::menuUpdateNeeded, this, &MainWindow::UpdateMenuAndStatusBar);
     connect(logTab, &LogTab::exportToTab, this, &MainWindow::ExportEventsToTab);
     connect(logTab, &LogTab::openFile, this, &MainWindow::LoadLogFile);
     int idx = tabWidget->addTab(logTab, label);
-    m_allFiles.append(SystemCase(path));
 
     TreeModel* model = logTab->GetTreeModel();
 
-    if (!isDirectory)
+    model->SetTabType(type);
+    model->m_loadFilter = filter;
+    if (type == TABTYPE::SingleFile)
     {
         model->m_paths.append(path);
-        model->SetTabType(TABTYPE::SingleFile);
     }
-    else
+    if (ShowsWholeFiles(model))
     {
-        model->SetTabType(TABTYPE::Directory);
+        m_allFiles.append(SystemCase(path));
+        // Log trees are added with their patterns, as their root alone would reopen as a live directory
+        if (type != TABTYPE::LogTree)
+            AddRecentFile(path);
     }
-    AddRecentFile(path);
     logTab->SetTabPath(path);
-    actionTail_current_tab->setEnabled(model->TabType() != TABTYPE::ExportedEvents);
+    const bool isPaged = model->GetPagedEvents() != nullptr;
+    actionTail_current_tab->setEnabled(!isPaged && (model->TabType() == TABTYPE::SingleFile || model->TabType() == TABTYPE::Directory));
 
     tabWidget->setTabToolTip(idx, path);
     tabWidget->setCurrentIndex(idx);
     logTab->setFocus();
 
     bool futureTabsUnderLive = m_options.getFutureTabsUnderLive();
-    if (isDirectory || futureTabsUnderLive)
+    if (type == TABTYPE::Directory || (type == TABTYPE::SingleFile && futureTabsUnderLive && !isPaged))
     {
         actionTail_current_tab->setChecked(true);
         on_actionTail_current_tab_triggered();
@@ -568,6 +657,159 @@ void MainWindow::on_actionChoose_directory_triggered()
     }
 }
 
+void MainWindow::on_actionOpen_log_tree_triggered()
+{
+    QString rootPath = QFileDialog::getExistingDirectory(this, "Select the root of the log tree", GetOpenDefaultFolder());
+    if (rootPath.isEmpty() || !PickLogTreePatterns())
+        return;
+
+    m_lastOpenFolder = rootPath;
+    OpenLogTree(rootPath, m_logTreePatterns);
+}
+
+void MainWindow::on_actionOpen_zip_log_tree_triggered()
+{
+    QString zipPath = QFileDialog::getOpenFileName(this, "Select the zip archive of the log tree", GetOpenDefaultFolder(),
+                                                   "Zip Archives (*.zip);;All Files (*)");
+    if (zipPath.isEmpty() || !PickLogTreePatterns())
+        return;
+
+    m_lastOpenFolder = QFileInfo(zipPath).absolutePath();
+    OpenLogTree(zipPath, m_logTreePatterns);
+}
+
+bool MainWindow::PickLogTreePatterns()
+{
+    bool isOk;
+    QString patterns = QInputDialog::getText(this, "Open log tree",
+                                             "Files to open, as globs separated by spaces.\n"
+                                             "Globs with a / match the path under the root, and a glob starting with ! excludes files.",
+                                             QLineEdit::Normal, m_logTreePatterns, &isOk);
+    if (isOk)
+        m_logTreePatterns = patterns;
+    return isOk;
+}
+
+/// <summary>
+/// Open every matching file under rootPath in a single tab. Each file is parsed on its own core,
+/// then the files are merged on time. The File column shows the path under the root, which for
+/// a ziplogs bundle names the node and the process.
+/// </summary>
+void MainWindow::OpenLogTree(QString rootPath, const QString& patterns)
+{
+    rootPath.replace("\\", "/");
+    if (m_allFiles.contains(SystemCase(rootPath)))
+    {
+        FocusOpenedFile(rootPath);
+        return;
+    }
+
+    QStringList files = LogTree::FindFiles(rootPath, patterns);
+    if (files.isEmpty())
+    {
+        QMessageBox::information(this, tr("Open log tree"), tr("No files under \"%1\" match \"%2\"").arg(rootPath, patterns));
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QDir rootDir(rootPath);
+    QStringList fileNames;
+    for (const QString& file : files)
+    {
+        fileNames.append(rootDir.relativeFilePath(file));
+    }
+
+    const int fileCount = static_cast<int>(files.size());
+    std::vector<EventListPtr> fileEvents(fileCount);
+    std::vector<FileReadState> readStates(fileCount);
+    std::vector<int> skippedCounts(fileCount, 0);
+    ParallelUtils::ForRanges(fileCount, [&](int first, int last) {
+        for (int i = first; i < last; i++)
+        {
+            fileEvents[i] = LogReader::ReadEvents(files[i], skippedCounts[i], &readStates[i], fileNames[i]);
+        }
+    }, 1);
+    auto events = std::make_shared<EventList>(LogTree::MergeByTime(fileEvents));
+    fileEvents.clear();
+
+    QString label = QString("%1 tree").arg(QFileInfo(rootPath).fileName());
+    LogTab* logTab = SetUpTab(events, TABTYPE::LogTree, rootPath, label);
+    AddRecentFile(rootPath + RecentLogTreeSeparator + patterns);
+    TreeModel* model = logTab->GetTreeModel();
+    model->m_paths = files;
+    for (int i = 0; i < fileCount; i++)
+    {
+        model->m_readStates[files[i]] = readStates[i];
+    }
+    QApplication::restoreOverrideCursor();
+
+    int skippedCount = std::accumulate(skippedCounts.begin(), skippedCounts.end(), 0);
+    statusBar()->showMessage(QString("%1 events loaded from %2 files; %3 events skipped")
+                             .arg(QString::number(model->rowCount()), QString::number(fileCount), QString::number(skippedCount)), 3000);
+}
+
+void MainWindow::on_actionOpen_time_range_triggered()
+{
+    QString path = QFileDialog::getOpenFileName(this, "Select a log file to open a time range of", GetOpenDefaultFolder(),
+                                                "Log Files (*.txt *.log);;All Files (*)");
+    if (path.isEmpty())
+        return;
+    m_lastOpenFolder = QFileInfo(path).absolutePath();
+
+    // Compressed logs can only be read from the start, so there is nothing to gain over opening them whole
+    if (CompressedFile::IsCompressed(path))
+    {
+        QMessageBox::information(this, tr("Open time range"), tr("\"%1\" is compressed. Open it whole instead.").arg(path));
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    std::vector<TimeIndex::Sample> samples = TimeIndex::GetSamples(path);
+    QApplication::restoreOverrideCursor();
+    if (samples.empty())
+    {
+        QMessageBox::information(this, tr("Open time range"), tr("\"%1\" has no timestamped events").arg(path));
+        return;
+    }
+
+    TimeRangeDlg dialog(this, QFileInfo(path).fileName(), samples.front().time, samples.back().time);
+    if (dialog.exec() == QDialog::Accepted)
+        OpenTimeRange(path, samples, dialog.Start(), dialog.End());
+}
+
+/// <summary>
+/// Open the events of a log between two times. The sparse time index of the file finds where the
+/// window starts and ends, so only that part of the file is read and parsed. The samples are kept
+/// on the model, as sampling a huge file again is slow when its index cannot be saved.
+/// </summary>
+void MainWindow::OpenTimeRange(QString path, const std::vector<TimeIndex::Sample>& samples, qint64 start, qint64 end)
+{
+    path.replace("\\", "/");
+    QString fileName = QFileInfo(path).fileName();
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    auto events = std::make_shared<EventList>();
+    int skippedCount = 0;
+    bool isRead = TimeIndex::ReadWindow(path, fileName, samples, start, end, *events, skippedCount);
+    QApplication::restoreOverrideCursor();
+    if (!isRead)
+    {
+        QMessageBox::warning(this, tr("Unable to open file"), tr("Unable to open file \"%1\"").arg(path));
+        return;
+    }
+
+    QString label = QString("%1 [%2 - %3]").arg(fileName, TimeUtils::FormatTime(start), TimeUtils::FormatTime(end));
+    LogTab* logTab = SetUpTab(events, TABTYPE::TimeRange, path, label);
+    TreeModel* model = logTab->GetTreeModel();
+    model->m_paths.append(path);
+    model->m_rangeStart = start;
+    model->m_rangeEnd = end;
+    model->m_rangeSamples = samples;
+
+    statusBar()->showMessage(QString("%1 events loaded; %2 events skipped")
+                             .arg(QString::number(model->rowCount()), QString::number(skippedCount)), 3000);
+}
+
 void MainWindow::dragEnterEvent(QDragEnterEvent *e)
 {
     if (e->mimeData()->hasUrls())
@@ -627,7 +869,8 @@ void MainWindow::on_tabWidget_tabCloseRequested(int index)
         return;
 
     LogTab * logTab = GetLogTab(index);
-    m_allFiles.removeAll(SystemCase(logTab->GetTabPath()));
+    if (ShowsWholeFiles(logTab->GetTreeModel()))
+        m_allFiles.removeAll(SystemCase(logTab->GetTabPath()));
     logTab->EndLiveCapture();
 
     QWidget* tabItem = tabWidget->widget(index);
@@ -643,6 +886,23 @@ void MainWindow::on_actionOpen_in_new_tab_triggered()
         LoadLogFile(file);
 }
 
+void MainWindow::on_actionOpen_with_filter_triggered()
+{
+    QStringList files = PickLogFilesToOpen("Select one or more log files to open with a filter");
+    if (files.isEmpty())
+        return;
+
+    LoadFilterDlg dialog(this, m_lastLoadFilter);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    m_lastLoadFilter = dialog.GetFilter();
+    for (const QString& file : files)
+    {
+        LoadFilteredLogFile(file, m_lastLoadFilter);
+    }
+}
+
 void MainWindow::on_actionOpen_log_txt_triggered()
 {
     if (!LoadLogFile(PathHelper::GetTableauLogFilePath(false)))
@@ -701,12 +961,50 @@ void MainWindow::on_actionRefresh_triggered()
 
     // TODO: Save the current line ID and go back to the line after refresh.
 
+    // A time range tab reads its window again, which only reads around the window
+    if (model->TabType() == TABTYPE::TimeRange)
+    {
+        const QString path = model->m_paths.value(0);
+        // Appended lines are past the last sample and still read. A file that shrank was rewritten.
+        if (model->m_rangeSamples.empty() || model->m_rangeSamples.back().offset >= QFileInfo(path).size())
+            model->m_rangeSamples = TimeIndex::GetSamples(path);
+        int skipped = 0;
+        EventList events;
+        TimeIndex::ReadWindow(path, QFileInfo(path).fileName(), model->m_rangeSamples,
+                              model->m_rangeStart, model->m_rangeEnd, events, skipped);
+        model->removeRows(0, model->rowCount());
+        if (!events.isEmpty())
+            model->MergeIntoModelData(events);
+        UpdateMenuAndStatusBar();
+        return;
+    }
+
+    // When the files only grew, and the tab still has exactly the events read from them,
+    // only the appended lines are read. Otherwise everything is read again.
+    bool isAppendOnly = !model->m_paths.isEmpty();
+    int readEventCount = 0;
+    for (const QString& path : model->m_paths)
+    {
+        const FileReadState state = model->m_readStates.value(path);
+        isAppendOnly = isAppendOnly && LogReader::IsAppendedTo(path, state);
+        readEventCount += state.eventCount;
+    }
+    isAppendOnly = isAppendOnly && readEventCount == model->rowCount();
+
     int skipped = 0;
-    model->removeRows(0, model->rowCount());
+    if (!isAppendOnly)
+    {
+        model->removeRows(0, model->rowCount());
+        model->m_readStates.clear();
+    }
+    // Log tree tabs show the paths of the files relative to the root of the tree
+    QDir treeRoot(GetCurrentLogTab()->GetTabPath());
     for (QString path : model->m_paths)
     {
-        EventListPtr events(GetEventsFromFile(path, skipped));
-        model->MergeIntoModelData(*events);
+        QString fileName = (model->TabType() == TABTYPE::LogTree) ? treeRoot.relativeFilePath(path) : QString();
+        EventListPtr events(LogReader::ReadEvents(path, skipped, &model->m_readStates[path], fileName, &model->m_loadFilter));
+        if (!events->isEmpty())
+            model->MergeIntoModelData(*events);
     }
 
     if (model->m_highlightOnlyMode)
@@ -896,6 +1194,10 @@ void MainWindow::on_actionFind_previous_triggered()
 void MainWindow::on_actionOptions_triggered()
 {
     QString prevThemeName = m_options.getTheme();
+    QString prevNotation = m_options.getNotation();
+    bool prevSearchRawValue = m_options.getSearchRawValue();
+    bool prevShowArtDataInValue = m_options.getShowArtDataInValue();
+    bool prevShowErrorCodeInValue = m_options.getShowErrorCodeInValue();
 
     OptionsDlg optionsDlg(this);
     optionsDlg.exec();
@@ -903,215 +1205,91 @@ void MainWindow::on_actionOptions_triggered()
     //Update if user change theme
     if (prevThemeName != m_options.getTheme())
         UpdateTheme();
+
+    // The value text that find and highlight match against depends on these options
+    bool searchChanged = prevNotation != m_options.getNotation() ||
+        prevSearchRawValue != m_options.getSearchRawValue() ||
+        prevShowArtDataInValue != m_options.getShowArtDataInValue() ||
+        prevShowErrorCodeInValue != m_options.getShowErrorCodeInValue();
+    for (int i = 0; searchChanged && i < tabWidget->count(); i++)
+    {
+        LogTab* logTab = GetLogTab(i);
+        logTab->GetTreeModel()->ClearSearchCache();
+        logTab->RefilterTreeView();
+    }
 }
 
-QString msecsToString(qint64 mseconds)
+void MainWindow::on_actionRecord_trace_toggled(bool checked)
 {
-    const qint64 msPerDay = 24 * 60 * 60 * 1000;
-    qint64 days = mseconds / msPerDay;
-    QTime t = QTime(0, 0).addMSecs(mseconds % msPerDay);
-    QString str = (days > 0) ? QString("%1 day(s), ").arg(days) : "";
-    str += QString("%1:%2:%3.%4 h:m:s")
-            .arg(t.hour(), 2, 10, QChar('0'))
-            .arg(t.minute(), 2, 10, QChar('0'))
-            .arg(t.second(), 2, 10, QChar('0'))
-            .arg(t.msec(), 2, 10, QChar('0'));
-    return str;
+    Trace::SetRecording(checked);
+    statusBar()->showMessage(checked ? "Recording a trace" : "Trace recording stopped", 3000);
 }
 
-void ShowSummary(TreeModel* model, QWidget* parent)
+/// <summary>
+/// Save what was recorded as Chrome trace JSON. Users can send the file when loading or
+/// filtering is slow on their machine.
+/// </summary>
+void MainWindow::on_actionSave_trace_triggered()
 {
-    typedef std::map<QString, int> CounterMap;
-
-    struct SummaryCounter
-    {
-        QString Description;
-        QString Key;
-        QString Value;
-        int Count;
-        std::unique_ptr<CounterMap> SubCounters;
-    };
-
-    QString beginQueryEventKey = "begin-query";
-    for (int i = 0; i < model->rowCount(); i++)
-    {
-        QModelIndex valIndex = model->index(i, COL::Value);
-        QString keyString = model->GetEvent(valIndex)["k"].toString();
-        if (keyString == "begin-query")
-        {
-            break;
-        }
-        else if (keyString == "begin-protocol.query")
-        {
-            beginQueryEventKey = "begin-protocol.query";
-            break;
-        }
-    }
-
-    SummaryCounter counters[] {
-        { "Workbook opened", "command-post", "tabui:open-workbook", 0, nullptr },
-        { "Query batch", "qp-batch-summary", nullptr, 0, nullptr },
-        { "Query", beginQueryEventKey, nullptr, 0, nullptr },
-        { "Query category", beginQueryEventKey, "query-category", 0, std::make_unique<CounterMap>() },
-    };
-
-    const int rowCount = model->rowCount();
-    for (int i = 0; i < rowCount; i++)
+    if (Trace::ScopeCount() == 0)
     {
-        QModelIndex valIndex = model->index(i, COL::Value);
-        QString valString = model->GetValueFullString(valIndex);
-        QJsonObject event = model->GetEvent(valIndex);
-        QString keyString = event["k"].toString();
-        auto valObj = event["v"];
-        for (SummaryCounter& counter : counters)
-        {
-            // Must match full key string.
-            if (keyString != counter.Key)
-                continue;
-
-            // Simple key only or key-value counter.
-            if (counter.Value.isNull() ||
-                (valString.contains(counter.Value)))
-            {
-                counter.Count++;
-            }
-
-            // Sub-counters: match counter.Value with the key part of "v" key-value pairs,
-            // and bucket-count the different values.
-            if (counter.SubCounters && valObj.isObject())
-            {
-                QJsonObject json = valObj.toObject();
-                QString& subKey = counter.Value;
-                if (json.contains(subKey))
-                {
-                    QString subValue = json[subKey].toString();
-                    (*counter.SubCounters)[subValue]++;
-                }
-            }
-        }
+        QMessageBox::information(this, tr("Save trace"), tr("Nothing was recorded. Turn on Help > Debug > Record trace, "
+                                                             "then do what is slow before saving the trace."));
+        return;
     }
 
-    QString summaryText;
-    if (rowCount > 0)
-    {
-        auto firstIdx = model->index(0, COL::Time);
-        auto lastIdx = model->index(model->rowCount() - 1, COL::Time);
-        QString firstTimestamp = model->data(firstIdx, Qt::DisplayRole).toString();
-        QString lastTimestamp = model->data(lastIdx, Qt::DisplayRole).toString();
-        auto firstDT = model->data(firstIdx, Qt::UserRole).toLongLong();
-        auto lastDT = model->data(lastIdx, Qt::UserRole).toLongLong();
-        auto diff = (lastDT - firstDT);
-        summaryText += QString("Begin: %1\nEnd: %2\nSpan: %3\n\n")
-                .arg(firstTimestamp).arg(lastTimestamp).arg(msecsToString(diff));
-    }
+    QString path = QFileDialog::getSaveFileName(this, tr("Save trace"), PathHelper::GetDocumentsPath() + "/tlv-trace.json",
+                                                tr("Trace files (*.json)"));
+    if (path.isEmpty())
+        return;
 
-    summaryText += "Number of";
-    summaryText += QString("\n    Event: %L1").arg(rowCount);
-    for (const SummaryCounter& counter : counters)
+    QString error;
+    if (!Trace::Save(path, error))
     {
-        summaryText += QString("\n    %1: %L2").arg(counter.Description).arg(counter.Count);
-        if (counter.SubCounters && counter.SubCounters->size())
-        {
-            for (const auto& sc : *counter.SubCounters)
-            {
-                int subCount = sc.second;
-                float subCountPercent = subCount * 100.0 / counter.Count;
-                summaryText += QString("\n    - %1: %L2 (%3%)").arg(sc.first).arg(subCount, 3).arg(subCountPercent, 0, 'f', 1);
-            }
-        }
+        QMessageBox::warning(this, tr("Save trace"), tr("Cannot write \"%1\": %2").arg(path, error));
+        return;
     }
-
-    QMessageBox msgBox(parent);
-    msgBox.setWindowTitle("Summary");
-    msgBox.setText(summaryText);
-    msgBox.exec();
+    statusBar()->showMessage(QString("Trace saved to %1").arg(path), 3000);
 }
 
-void MainWindow::on_actionShow_summary_triggered()
-{
-    ShowSummary(GetCurrentTreeModel(), this);
-}
-
-void ConvertJsonToStringMap(const QJsonObject& valJson, const QStringList& fields, QMap<QString, QString>& nameValues)
+void MainWindow::on_actionDrop_caches_triggered()
 {
-    for (const auto& field : fields)
+    qint64 freedBytes = 0;
+    for (int i = 0; i < tabWidget->count(); i++)
     {
-        const auto& val = valJson[field];
-        if (val.isDouble())
-        {
-            double intpart;
-            const int decimals = (modf(val.toDouble(), &intpart) == 0) ? 0 : 3;
-            nameValues[field] = QString::number(val.toDouble(), 'f', decimals);
-        }
-        else if (val.isString())
-        {
-            QString strVal = val.toString();
-            strVal.truncate(32000); // Excel cannot handle more than ~32K chars.
-            nameValues[field] = "\"" % strVal.replace("\n", "\\n").replace("\"", "\"\"") % "\"";
-        }
-        else if (val.isObject())
-        {
-            ConvertJsonToStringMap(val.toObject(), fields, nameValues);
-        }
-        else if (!nameValues.contains(field))
-        {
-            nameValues[field] = "";
-        }
+        TreeModel* model = GetLogTab(i)->GetTreeModel();
+        qint64 bytesBefore = model->GetMemoryUsage().Total();
+        model->DropCaches();
+        freedBytes += bytesBefore - model->GetMemoryUsage().Total();
     }
+    UpdateMenuAndStatusBar();
+    statusBar()->showMessage(QString("About %1 freed").arg(QLocale().formattedDataSize(std::max<qint64>(freedBytes, 0))), 3000);
 }
 
-void WriteJsonAsCsv(const QJsonObject& valJson, QStringList& fields, QString& outputStr)
+void MainWindow::on_actionClear_index_cache_triggered()
 {
-    // If list of fields is not specified, set it to all fields available in the first event.
-    if (fields.isEmpty())
-    {
-        fields = valJson.keys();
-    }
-
-    QMap<QString, QString> nameValues;
-
-    ConvertJsonToStringMap(valJson, fields, nameValues);
-
-    for (const auto& field : fields)
-    {
-        outputStr += nameValues[field] + ",";
-    }
-    outputStr.truncate(outputStr.size() - 1);
-    outputStr += "\n";
+    qint64 freedBytes = IndexCache::Clear();
+    statusBar()->showMessage(QString("%1 of index files deleted").arg(QLocale().formattedDataSize(freedBytes)), 3000);
 }
 
-bool CreateFolder(const QString& path)
+void ShowSummary(TreeModel* model, QWidget* parent)
 {
-    QDir folder(path);
-    if (!folder.exists() && !folder.mkpath("."))
-    {
-        QMessageBox warning(
-            QMessageBox::Icon::Warning,
-            "Error creating directory",
-            folder.path());
-        warning.exec();
-        return false;
-    }
-    return true;
+    if (!model)
+        return;
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QString summaryText = Reports::Summary(model);
+    QApplication::restoreOverrideCursor();
+
+    QMessageBox msgBox(parent);
+    msgBox.setWindowTitle("Summary");
+    msgBox.setText(summaryText);
+    msgBox.exec();
 }
 
-bool SaveFile(const QString& path, const QString& filename, const QStringList& headers, const QString& content)
+void MainWindow::on_actionShow_summary_triggered()
 {
-    QFile file(path + "/" + filename);
-    if (!file.open(QIODevice::WriteOnly))
-    {
-        QMessageBox warning(
-            QMessageBox::Icon::Warning,
-            "Error writing file",
-            file.fileName());
-        warning.exec();
-        return false;
-    }
-
-    QString output = headers.join(',') + "\n" + content;
-    file.write(output.toUtf8().data());
-    file.close();
-    return true;
+    ShowSummary(GetCurrentTreeModel(), this);
 }
 
 bool CopyAllFiles(const QString& fromPath, const QString& toPath)
@@ -1169,97 +1347,8 @@ void GeQueryInfoViz(TreeModel* model)
     if (!model)
         return;
 
-    QString outputQuery;
-    QString outputTempTable;
-    QString outputProtocol;
-    QString outputFedTempTable;
-    QString outputElapsedEvent;
-    QStringList fieldsQuery{"cols", "elapsed", "protocol-id", "query", "query-category", "query-hash", "rows"};
-    QStringList fieldsTempTable{"elapsed",    "elapsed-create", "elapsed-insert",    "num-columns",
-                                "num-tuples", "protocol-id",    "source-query-hash", "tablename"};
-    QStringList fieldsProtocol{"id", "created-elapsed", "attributes", "class", "dbname", "server"};
-    QStringList fieldsFedTempTable{"query-hash", "table-name"};
-    QStringList fieldsElapsedEvent{"line-id", "time", "elapsed", "begin", "file", "pid", "event", "value"};
-
-    const int rowCount = model->rowCount();
-    for (int i = 0; i < rowCount; i++)
-    {
-        QModelIndex valIndex = model->index(i, COL::Value);
-        QJsonObject event = model->GetEvent(valIndex);
-        QString keyString = event["k"].toString();
-
-        auto elapsed = model->index(i, COL::Elapsed).data().toDouble();
-        if (elapsed != 0.0)
-        {
-            auto strId = model->index(i, COL::ID).data().toString();
-            auto strTime = event["ts"].toString();
-            auto strElapsed = QString::number(elapsed, 'f', 3);
-            auto beginTime = model->index(i, COL::Time).data(Qt::UserRole).toDateTime().toMSecsSinceEpoch() - (elapsed * 1000);
-            auto strFile = model->index(i, COL::File).data().toString();
-            auto strPid = model->index(i, COL::PID).data().toString();
-            auto strValue = model->GetValueFullString(valIndex);
-            if (strValue.size() > 3000)
-            {
-                strValue.truncate(3000);
-                strValue += "...";
-            }
-            strValue.replace("\n", "\\n").replace("\"", "\"\"");
-            outputElapsedEvent += QString("%1,\"%2\",%3,%4,\"%5\",%6,\"%7\",\"%8\"\n")
-                                      .arg(
-                                          strId, strTime, strElapsed, QString::number(beginTime, 'f', 0), strFile,
-                                          strPid, keyString, strValue);
-        }
-
-        if (keyString == "end-query")
-        {
-            const QJsonObject& valJson = event["v"].toObject();
-            WriteJsonAsCsv(valJson, fieldsQuery, outputQuery);
-
-            // For federated queries, parsed out all the temp tables used and create a separate list.
-            QString queryText = valJson["query"].toString();
-            if (queryText.contains("FQ_Temp_"))
-            {
-                QRegularExpression regex;
-                if (queryText.startsWith("(restrict"))
-                {
-                    regex.setPattern("table (.*?)\\)");
-                }
-                else if (queryText.startsWith("SELECT "))
-                {
-                    regex.setPattern("\"(#Tableau_.*?)\" ");
-                }
-                else
-                {
-                    continue;
-                }
-
-                QString queryHash = QString::number(valJson["query-hash"].toDouble(), 'f', 0);
-                QRegularExpressionMatchIterator i = regex.globalMatch(queryText);
-                while (i.hasNext())
-                {
-                    QRegularExpressionMatch match = i.next();
-                    QString tableName = match.captured(1);
-                    if (!tableName.startsWith("["))
-                    {
-                        // Hyper does not use square brackets for table names, but the table names
-                        // we log in sql-temp-table events have them.
-                        tableName = "[" % tableName % "]";
-                    }
-                    outputFedTempTable += queryHash % ",\"" % tableName % "\"\n";
-                }
-            }
-        }
-        else if (keyString == "end-sql-temp-table-tuples-create")
-        {
-            WriteJsonAsCsv(event["v"].toObject(), fieldsTempTable, outputTempTable);
-        }
-        else if (keyString == "construct-protocol")
-        {
-            WriteJsonAsCsv(event["v"].toObject(), fieldsProtocol, outputProtocol);
-        }
-    }
-
-    if (outputElapsedEvent.isEmpty())
+    std::vector<Reports::CsvFile> csvFiles = Reports::QueryCsvFiles(model);
+    if (csvFiles.empty())
     {
         QMessageBox warning(QMessageBox::Icon::Warning, "Error", "No parsable event found.");
         warning.exec();
@@ -1267,16 +1356,15 @@ void GeQueryInfoViz(TreeModel* model)
     }
 
     QString docFolderPath = QStandardPaths::standardLocations(QStandardPaths::DocumentsLocation)[0] + "/TLV";
-    if (CreateFolder(docFolderPath) &&
-        SaveFile(docFolderPath, "TLV_Query.csv", fieldsQuery, outputQuery) &&
-        SaveFile(docFolderPath, "TLV_FedTempTable.csv", fieldsFedTempTable, outputFedTempTable) &&
-        SaveFile(docFolderPath, "TLV_TempTable.csv", fieldsTempTable, outputTempTable) &&
-        SaveFile(docFolderPath, "TLV_Protocol.csv", fieldsProtocol, outputProtocol) &&
-        SaveFile(docFolderPath, "TLV_ElapsedEvent.csv", fieldsElapsedEvent, outputElapsedEvent))
+    QString error;
+    if (!Reports::SaveCsvFiles(csvFiles, docFolderPath, error))
     {
-        CopyAllFiles(":/workbooks", docFolderPath);
-        QDesktopServices::openUrl(QUrl::fromLocalFile(docFolderPath));
+        QMessageBox warning(QMessageBox::Icon::Warning, "Error writing file", error);
+        warning.exec();
+        return;
     }
+    CopyAllFiles(":/workbooks", docFolderPath);
+    QDesktopServices::openUrl(QUrl::fromLocalFile(docFolderPath));
 }
 
 void MainWindow::on_actionCreate_info_viz_triggered()
@@ -1346,7 +1434,7 @@ void MainWindow::FindImpl(int offset, bool findHighlight)
                     QString data;
                     if (col == COL::Value)
                     {
-                        data = model->GetValueFullString(idx, true);
+                        data = model->GetValueSearchString(idx);
                     }
                     else if (col == COL::ART || col == COL::ErrorCode)
                     {
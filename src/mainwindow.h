@@ -3,6 +3,7 @@
 
 #include "logtab.h"
 #include "statusbar.h"
+#include "timeindex.h"
 #include "treemodel.h"
 #include "ui_mainwindow.h"
 
@@ -45,6 +46,7 @@ private slots:
     //Slots use underscores as per QT's automatic connection syntax
     //File
     void on_actionOpen_in_new_tab_triggered();
+    void on_actionOpen_with_filter_triggered();
     void on_actionOpen_log_txt_triggered();
     void on_actionOpen_beta_log_txt_triggered();
     void on_actionMerge_into_tab_triggered();
@@ -70,6 +72,10 @@ private slots:
     void on_actionFind_previous_triggered();
 
     void on_actionOptions_triggered();
+    void on_actionRecord_trace_toggled(bool checked);
+    void on_actionSave_trace_triggered();
+    void on_actionDrop_caches_triggered();
+    void on_actionClear_index_cache_triggered();
     void on_tabWidget_currentChanged(int index);
     void on_tabWidget_tabCloseRequested(int index);
 
@@ -79,13 +85,14 @@ private slots:
     void on_actionLog_directory_triggered();
     void on_actionBeta_log_directory_triggered();
     void on_actionChoose_directory_triggered();
+    void on_actionOpen_log_tree_triggered();
+    void on_actionOpen_zip_log_tree_triggered();
+    void on_actionOpen_time_range_triggered();
 
 private:
     void WriteSettings();
     void ReadSettings();
 
-    EventListPtr GetEventsFromFile(QString path, int & skippedCount);
-
     TreeModel * GetCurrentTreeModel();
     QTreeView * GetCurrentTreeView();
     LogTab * GetCurrentLogTab();
@@ -98,6 +105,7 @@ private:
     void AddRecentFile(const QString& path);
     void RemoveRecentFile(const QString& path);
 
+    bool LoadFilteredLogFile(QString path, const LoadFilter& filter);
     void MergeLogFile(QString path);
     void FindPrev();
     void FindNext();
@@ -106,13 +114,21 @@ private:
     void FindImpl(int offset, bool findHighlight);
 
     void StartDirectoryLiveCapture(QString directoryPath, QString label);
+    bool PickLogTreePatterns();
+    void OpenLogTree(QString rootPath, const QString& patterns);
+    void OpenTimeRange(QString path, const std::vector<TimeIndex::Sample>& samples, qint64 start, qint64 end);
     void FocusOpenedFile(QString path);
-    LogTab* SetUpTab(EventListPtr events, bool isDirectory, QString path, QString label);
+    LogTab* SetUpTab(EventListPtr events, TABTYPE type, QString path, QString label,
+                     const LoadFilter& filter = LoadFilter());
+    LogTab* SetUpTab(LogTab* logTab, TABTYPE type, QString path, QString label,
+                     const LoadFilter& filter = LoadFilter());
 
     Options& m_options = Options::GetInstance();
     StatusBar * m_statusBar;
     QStringList m_recentFiles;
     QString m_lastOpenFolder;
+    QString m_logTreePatterns = "*.txt *.log *.gz *.zst";
+    LoadFilter m_lastLoadFilter;
 
     // m_liveFiles is used to store all the files that have been opened/are open in the MainWindow.
     // If a user opens a new tab, this structure is used to check the file path of the file being loaded
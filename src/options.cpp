@@ -27,6 +27,13 @@ void Options::ReadSettings()
     m_captureAllTextFiles = settings.value("liveCaptureAllTextFiles", true).toBool();
     m_showArtDataInValue = settings.value("showArtDataInValue", false).toBool();
     m_showErrorCodeInValue = settings.value("showErrorCodeInValue", false).toBool();
+    m_searchRawValue = settings.value("searchRawValue", false).toBool();
+    QStringList defaultElapsedKeys = {"elapsed", "created-elapsed"};
+    m_elapsedKeys = settings.value("elapsedKeys", defaultElapsedKeys).toStringList();
+    QStringList defaultElapsedMsKeys = {"elapsedMs", "elapsed-ms"};
+    m_elapsedMsKeys = settings.value("elapsedMsKeys", defaultElapsedMsKeys).toStringList();
+    m_indexLargeLogs = settings.value("indexLargeLogs", true).toBool();
+    m_pagedLogSize = settings.value("pagedLogSize", 2048).toInt();
     m_syntaxHighlightLimit = settings.value("syntaxHighlightLimit", 15000).toInt();
     m_theme = settings.value("theme", "Native").toString();
     m_notation = settings.value("notation", "YAML").toString();
@@ -58,6 +65,11 @@ void Options::WriteSettings()
     settings.setValue("liveCaptureAllTextFiles", m_captureAllTextFiles);
     settings.setValue("showArtDataInValue", m_showArtDataInValue);
     settings.setValue("showErrorCodeInValue", m_showErrorCodeInValue);
+    settings.setValue("searchRawValue", m_searchRawValue);
+    settings.setValue("elapsedKeys", m_elapsedKeys);
+    settings.setValue("elapsedMsKeys", m_elapsedMsKeys);
+    settings.setValue("indexLargeLogs", m_indexLargeLogs);
+    settings.setValue("pagedLogSize", m_pagedLogSize);
     settings.setValue("defaultHighlightFilter", m_defaultFilterName);
     settings.setValue("syntaxHighlightLimit", m_syntaxHighlightLimit);
     settings.setValue("theme", m_theme);
@@ -145,6 +157,56 @@ void Options::setShowErrorCodeInValue(const bool showErrorCodeInValue)
     m_showErrorCodeInValue = showErrorCodeInValue;
 }
 
+bool Options::getSearchRawValue() const
+{
+    return m_searchRawValue;
+}
+
+void Options::setSearchRawValue(const bool searchRawValue)
+{
+    m_searchRawValue = searchRawValue;
+}
+
+QStringList Options::getElapsedKeys() const
+{
+    return m_elapsedKeys;
+}
+
+void Options::setElapsedKeys(const QStringList& elapsedKeys)
+{
+    m_elapsedKeys = elapsedKeys;
+}
+
+QStringList Options::getElapsedMsKeys() const
+{
+    return m_elapsedMsKeys;
+}
+
+void Options::setElapsedMsKeys(const QStringList& elapsedMsKeys)
+{
+    m_elapsedMsKeys = elapsedMsKeys;
+}
+
+bool Options::getIndexLargeLogs() const
+{
+    return m_indexLargeLogs;
+}
+
+void Options::setIndexLargeLogs(const bool indexLargeLogs)
+{
+    m_indexLargeLogs = indexLargeLogs;
+}
+
+int Options::getPagedLogSize() const
+{
+    return m_pagedLogSize;
+}
+
+void Options::setPagedLogSize(const int pagedLogSize)
+{
+    m_pagedLogSize = pagedLogSize;
+}
+
 bool Options::getCaptureAllTextFiles() const
 {
     return m_captureAllTextFiles;
@@ -170,6 +232,11 @@ HighlightOptions Options::getDefaultHighlightOpts()
     return m_defaultHighlightOpts;
 }
 
+void Options::setDefaultHighlightOpts(const HighlightOptions& defaultHighlightOpts)
+{
+    m_defaultHighlightOpts = defaultHighlightOpts;
+}
+
 void Options::LoadHighlightFilter(const QString& filterName)
 {
     QDir loadDir(PathHelper::GetFiltersConfigPath());
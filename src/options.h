@@ -20,6 +20,11 @@ private:
     bool m_captureAllTextFiles;
     bool m_showArtDataInValue;
     bool m_showErrorCodeInValue;
+    bool m_searchRawValue;
+    QStringList m_elapsedKeys;
+    QStringList m_elapsedMsKeys;
+    bool m_indexLargeLogs;
+    int m_pagedLogSize;
     QString m_defaultFilterName;
     HighlightOptions m_defaultHighlightOpts;
     int m_syntaxHighlightLimit;
@@ -63,10 +68,27 @@ public:
     bool getShowErrorCodeInValue() const;
     void setShowErrorCodeInValue(const bool showErrorCodeInValue);
 
+    bool getSearchRawValue() const;
+    void setSearchRawValue(const bool searchRawValue);
+
+    QStringList getElapsedKeys() const;
+    void setElapsedKeys(const QStringList& elapsedKeys);
+
+    QStringList getElapsedMsKeys() const;
+    void setElapsedMsKeys(const QStringList& elapsedMsKeys);
+
+    bool getIndexLargeLogs() const;
+    void setIndexLargeLogs(const bool indexLargeLogs);
+
+    // In MB, 0 never pages
+    int getPagedLogSize() const;
+    void setPagedLogSize(const int pagedLogSize);
+
     QString getDefaultFilterName() const;
     void setDefaultFilterName(const QString& defaultFilterName);
 
     HighlightOptions getDefaultHighlightOpts();
+    void setDefaultHighlightOpts(const HighlightOptions& defaultHighlightOpts);
 
     int getSyntaxHighlightLimit() const;
     void setSyntaxHighlightLimit(const int syntaxHighlightLimit);
@@ -27,6 +27,19 @@ OptionsDlg::~OptionsDlg()
     delete ui;
 }
 
+// Keys typed as a comma separated list
+static QStringList SplitKeyList(const QString& text)
+{
+    QStringList keys;
+    for (const QString& key : text.split(",", Qt::SkipEmptyParts))
+    {
+        QString trimmed = key.trimmed();
+        if (!trimmed.isEmpty())
+            keys.append(trimmed);
+    }
+    return keys;
+}
+
 void OptionsDlg::WriteSettings()
 {
     Options& options = Options::GetInstance();
@@ -48,6 +61,11 @@ void OptionsDlg::WriteSettings()
     options.setCaptureAllTextFiles(ui->captureAllTextFiles->isChecked());
     options.setShowArtDataInValue(ui->showArtDataInValue->isChecked());
     options.setShowErrorCodeInValue(ui->showErrorCodeInValue->isChecked());
+    options.setSearchRawValue(ui->searchRawValue->isChecked());
+    options.setIndexLargeLogs(ui->indexLargeLogs->isChecked());
+    options.setPagedLogSize(ui->pagedLogSizeSpinBox->value());
+    options.setElapsedKeys(SplitKeyList(ui->elapsedKeysEdit->text()));
+    options.setElapsedMsKeys(SplitKeyList(ui->elapsedMsKeysEdit->text()));
     options.setDefaultFilterName(ui->defaultHighlightComboBox->currentText());
     options.setSyntaxHighlightLimit(ui->syntaxHighlightLimitSpinBox->value());
     options.setTheme(ui->themeComboBox->currentText());
@@ -81,6 +99,11 @@ void OptionsDlg::ReadSettings()
     ui->captureAllTextFiles->setChecked(options.getCaptureAllTextFiles());
     ui->showArtDataInValue->setChecked(options.getShowArtDataInValue());
     ui->showErrorCodeInValue->setChecked(options.getShowErrorCodeInValue());
+    ui->searchRawValue->setChecked(options.getSearchRawValue());
+    ui->indexLargeLogs->setChecked(options.getIndexLargeLogs());
+    ui->pagedLogSizeSpinBox->setValue(options.getPagedLogSize());
+    ui->elapsedKeysEdit->setText(options.getElapsedKeys().join(", "));
+    ui->elapsedMsKeysEdit->setText(options.getElapsedMsKeys().join(", "));
     ui->syntaxHighlightLimitSpinBox->setValue(options.getSyntaxHighlightLimit());
 
     const auto& themeNames = ThemeUtils::GetThemeNames();
@@ -0,0 +1,163 @@
+#include "pagedevents.h"
+
+#include "options.h"
+#include "processevent.h"
+#include "qjsonutils.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <QMutexLocker>
+
+namespace
+{
+    bool IsBlank(const char* line, qint64 length)
+    {
+        for (qint64 i = 0; i < length; i++)
+        {
+            if (!std::isspace(static_cast<unsigned char>(line[i])))
+                return false;
+        }
+        return true;
+    }
+
+    // The skip list of the options, as a filter that can run on the raw lines
+    LoadFilter ScanFilter(const LoadFilter& filter)
+    {
+        Options& options = Options::GetInstance();
+        QStringList skippedText = options.getSkippedText();
+        QBitArray skippedState = options.getSkippedState();
+        LoadFilter scanFilter = filter;
+        for (int i = 0; i < skippedText.size() && i < skippedState.size(); i++)
+        {
+            if (skippedState[i])
+                scanFilter.excludeKeys.insert(skippedText[i]);
+        }
+        return scanFilter;
+    }
+}
+
+PagedEvents::PagedEvents(const QString& path, const QString& fileName) :
+    m_file(path),
+    m_fileName(fileName)
+{
+}
+
+PagedEvents::~PagedEvents()
+{
+    if (m_data)
+        m_file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_data)));
+}
+
+std::shared_ptr<PagedEvents> PagedEvents::Open(const QString& path, const QString& fileName,
+                                               const LoadFilter& filter, int& skippedCount)
+{
+    std::shared_ptr<PagedEvents> events(new PagedEvents(path, fileName));
+    if (!events->m_file.open(QIODevice::ReadOnly))
+        return nullptr;
+    const qint64 size = events->m_file.size();
+    uchar* data = events->m_file.map(0, size);
+    if (!data)
+        return nullptr;
+    events->m_data = reinterpret_cast<const char*>(data);
+
+    int lineCount = 0;
+    if (!filter.IsActive() && EventIndex::LoadEntries(path, events->m_entries, skippedCount, lineCount))
+        return events;
+
+    // One pass over the lines to find where they are. Only lines with a skipped key, or that the
+    // filter rejects, are looked at more closely, and nothing is parsed.
+    const LoadFilter scanFilter = ScanFilter(filter);
+    const bool isFiltered = scanFilter.IsActive();
+    const char* text = events->m_data;
+    int fileSkippedCount = 0;
+    for (qint64 pos = 0; pos < size;)
+    {
+        const void* newline = std::memchr(text + pos, '\n', static_cast<size_t>(size - pos));
+        qint64 lineEnd = newline ? static_cast<const char*>(newline) - text : size;
+        qint64 length = lineEnd - pos;
+        if (!IsBlank(text + pos, length))
+        {
+            lineCount++;
+            if (isFiltered && scanFilter.Rejects(QString::fromUtf8(QByteArray::fromRawData(text + pos, length).trimmed())))
+                fileSkippedCount++;
+            else
+                events->m_entries.push_back({pos, static_cast<qint32>(length), lineCount});
+        }
+        pos = lineEnd + 1;
+    }
+    events->m_entries.shrink_to_fit();
+    skippedCount += fileSkippedCount;
+
+    if (!filter.IsActive() && Options::GetInstance().getIndexLargeLogs())
+        EventIndex::Save(path, events->m_entries, fileSkippedCount, lineCount);
+    return events;
+}
+
+int PagedEvents::Count() const
+{
+    return static_cast<int>(m_entries.size());
+}
+
+QJsonObject PagedEvents::At(int row) const
+{
+    const int page = row / PageSize;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (QList<QJsonObject>* events = m_pages.object(page))
+            return events->at(row % PageSize);
+    }
+
+    // Parse without holding the lock, so threads going through the rows parse their pages in parallel
+    auto events = new QList<QJsonObject>(ParsePage(page));
+    QJsonObject event = events->at(row % PageSize);
+    QMutexLocker locker(&m_mutex);
+    m_pages.insert(page, events);
+    return event;
+}
+
+qint64 PagedEvents::MemoryBytes() const
+{
+    qint64 bytes = static_cast<qint64>(m_entries.capacity()) * sizeof(EventIndex::Entry);
+    QMutexLocker locker(&m_mutex);
+    // The first event of each page stands for the others
+    for (int page : m_pages.keys())
+    {
+        const QList<QJsonObject>* events = m_pages.object(page);
+        if (events && !events->isEmpty())
+            bytes += events->size() * (sizeof(QJsonObject) + QJsonUtils::EstimatedSize(events->first()));
+    }
+    return bytes;
+}
+
+void PagedEvents::DropPages()
+{
+    QMutexLocker locker(&m_mutex);
+    m_pages.clear();
+}
+
+QList<QJsonObject> PagedEvents::ParsePage(int page) const
+{
+    Trace::Scope scope("ParsePage");
+    const int first = page * PageSize;
+    const int last = std::min(first + PageSize, Count());
+    QList<QJsonObject> events;
+    events.reserve(last - first);
+    for (int row = first; row < last; row++)
+    {
+        const EventIndex::Entry& entry = m_entries[row];
+        QString line = QString::fromUtf8(QByteArray::fromRawData(m_data + entry.offset, entry.length).trimmed());
+        QJsonObject event = ProcessEvent::ProcessLogEventMessage(entry.index, line, m_fileName);
+        if (event.isEmpty())
+        {
+            // The scan doesn't parse, so a line it kept may turn out not to be an event. Show its text.
+            event["idx"] = entry.index;
+            event["file"] = m_fileName;
+            event["k"] = "";
+            event["v"] = line;
+        }
+        events.append(event);
+    }
+    return events;
+}
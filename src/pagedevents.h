@@ -0,0 +1,54 @@
+#ifndef PAGEDEVENTS_H
+#define PAGEDEVENTS_H
+
+#include "eventindex.h"
+#include "loadfilter.h"
+
+#include <memory>
+#include <QCache>
+#include <QFile>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <vector>
+
+// Events of a log too large to keep parsed in memory. Only where the line of each event is stays
+// in memory. The lines are read from a mapping of the file and parsed a page at a time as the rows
+// are used, and the pages used last are kept.
+class PagedEvents
+{
+public:
+    // Maps the log and finds its events, from its index when there is a current one.
+    // Returns null when the file cannot be mapped.
+    static std::shared_ptr<PagedEvents> Open(const QString& path, const QString& fileName,
+                                             const LoadFilter& filter, int& skippedCount);
+    ~PagedEvents();
+
+    int Count() const;
+    // Can be called from several threads
+    QJsonObject At(int row) const;
+    // Estimated bytes of the line positions and of the parsed pages kept. The mapping of the file
+    // is left out, as the system pages it in and out.
+    qint64 MemoryBytes() const;
+    // Forgets the parsed pages, which get parsed again when used
+    void DropPages();
+
+private:
+    PagedEvents(const QString& path, const QString& fileName);
+    QList<QJsonObject> ParsePage(int page) const;
+
+    static const int PageSize = 256;
+    static const int MaxCachedPages = 64;
+
+    QFile m_file;
+    const char* m_data = nullptr;
+    QString m_fileName;
+    std::vector<EventIndex::Entry> m_entries;
+    mutable QMutex m_mutex;
+    mutable QCache<int, QList<QJsonObject>> m_pages{MaxCachedPages};
+};
+
+typedef std::shared_ptr<PagedEvents> PagedEventsPtr;
+
+#endif // PAGEDEVENTS_H
@@ -0,0 +1,80 @@
+#ifndef PARALLELUTILS_H
+#define PARALLELUTILS_H
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+#include <QThread>
+#include <QtConcurrent>
+
+namespace ParallelUtils
+{
+    // Calls func(first, last) from the global thread pool on consecutive ranges that cover [0, count).
+    // The ranges never overlap, so func can fill row-aligned arrays without locking.
+    template <typename Func>
+    void ForRanges(int count, Func func, int minRangeSize = 4096)
+    {
+        if (count <= minRangeSize)
+        {
+            func(0, count);
+            return;
+        }
+
+        std::vector<std::pair<int, int>> ranges;
+        for (int first = 0; first < count; first += minRangeSize)
+        {
+            ranges.emplace_back(first, std::min(first + minRangeSize, count));
+        }
+        QtConcurrent::blockingMap(ranges, [&func](const std::pair<int, int>& range) {
+            func(range.first, range.second);
+        });
+    }
+
+    // Stable sort of a permutation. Each thread sorts one chunk, then neighbouring chunks are merged
+    // in parallel until a single one is left.
+    template <typename Less>
+    void StableSort(std::vector<int>& rows, Less less, int minChunkSize = 1 << 15)
+    {
+        const int count = static_cast<int>(rows.size());
+        const int chunkCount = std::max(1, std::min(QThread::idealThreadCount(), count / minChunkSize));
+        if (chunkCount == 1)
+        {
+            std::stable_sort(rows.begin(), rows.end(), less);
+            return;
+        }
+
+        std::vector<std::pair<int, int>> chunks;
+        for (int i = 0; i < chunkCount; i++)
+        {
+            chunks.emplace_back(static_cast<int>(qint64(count) * i / chunkCount),
+                                static_cast<int>(qint64(count) * (i + 1) / chunkCount));
+        }
+        QtConcurrent::blockingMap(chunks, [&rows, &less](const std::pair<int, int>& chunk) {
+            std::stable_sort(rows.begin() + chunk.first, rows.begin() + chunk.second, less);
+        });
+
+        while (chunks.size() > 1)
+        {
+            // first, middle and last of each merge
+            std::vector<std::array<int, 3>> merges;
+            std::vector<std::pair<int, int>> merged;
+            for (size_t i = 0; i + 1 < chunks.size(); i += 2)
+            {
+                merges.push_back({chunks[i].first, chunks[i].second, chunks[i + 1].second});
+                merged.emplace_back(chunks[i].first, chunks[i + 1].second);
+            }
+            if (chunks.size() % 2 == 1)
+            {
+                merged.push_back(chunks.back());
+            }
+
+            QtConcurrent::blockingMap(merges, [&rows, &less](const std::array<int, 3>& merge) {
+                std::inplace_merge(rows.begin() + merge[0], rows.begin() + merge[1], rows.begin() + merge[2], less);
+            });
+            chunks.swap(merged);
+        }
+    }
+}
+
+#endif // PARALLELUTILS_H
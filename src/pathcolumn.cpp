@@ -0,0 +1,230 @@
+#include "pathcolumn.h"
+
+#include "parallelutils.h"
+#include "vectorutils.h"
+
+#include <cmath>
+#include <limits>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRegularExpression>
+
+namespace
+{
+    const double NoNumber = std::numeric_limits<double>::quiet_NaN();
+
+    const QRegularExpression& FilterRegex()
+    {
+        static const QRegularExpression regex("^\\s*(<=|>=|!=|=|<|>)\\s*(.*?)\\s*$");
+        return regex;
+    }
+
+    template<typename T>
+    bool Compare(PathColumn::Filter::Op op, const T& lhs, const T& rhs)
+    {
+        switch (op)
+        {
+            case PathColumn::Filter::Op::Equal:
+                return lhs == rhs;
+            case PathColumn::Filter::Op::NotEqual:
+                return lhs != rhs;
+            case PathColumn::Filter::Op::Less:
+                return lhs < rhs;
+            case PathColumn::Filter::Op::LessOrEqual:
+                return lhs <= rhs;
+            case PathColumn::Filter::Op::Greater:
+                return lhs > rhs;
+            case PathColumn::Filter::Op::GreaterOrEqual:
+                return lhs >= rhs;
+        }
+        return false;
+    }
+}
+
+PathColumn::PathColumn(const QString& path) :
+    m_path(path.trimmed()),
+    m_segments(m_path.split('.', Qt::SkipEmptyParts))
+{
+}
+
+const QString& PathColumn::Path() const
+{
+    return m_path;
+}
+
+int PathColumn::RowCount() const
+{
+    return static_cast<int>(m_numbers.size());
+}
+
+void PathColumn::Build(int count, const std::function<QJsonObject(int)>& eventAt)
+{
+    m_numbers.assign(count, NoNumber);
+    m_strings.assign(count, QString());
+
+    ParallelUtils::ForRanges(count, [this, &eventAt](int first, int last) {
+        for (int row = first; row < last; row++)
+        {
+            SetRow(row, eventAt(row));
+        }
+    });
+}
+
+void PathColumn::InsertRows(const std::vector<int>& rows, const std::function<QJsonObject(int)>& eventAt)
+{
+    VectorUtils::InsertAtRows(m_numbers, rows, [](int) { return NoNumber; });
+    VectorUtils::InsertAtRows(m_strings, rows, [](int) { return QString(); });
+
+    ParallelUtils::ForRanges(static_cast<int>(rows.size()), [this, &rows, &eventAt](int first, int last) {
+        for (int i = first; i < last; i++)
+        {
+            SetRow(rows[i], eventAt(rows[i]));
+        }
+    });
+}
+
+void PathColumn::RemoveRows(int row, int count)
+{
+    m_numbers.erase(m_numbers.begin() + row, m_numbers.begin() + row + count);
+    m_strings.erase(m_strings.begin() + row, m_strings.begin() + row + count);
+}
+
+void PathColumn::Clear()
+{
+    m_numbers.clear();
+    m_strings.clear();
+}
+
+qint64 PathColumn::MemoryBytes() const
+{
+    qint64 bytes = m_numbers.capacity() * sizeof(double) + m_strings.capacity() * sizeof(QString);
+    for (const QString& str : m_strings)
+    {
+        bytes += str.size() * sizeof(QChar);
+    }
+    return bytes;
+}
+
+bool PathColumn::HasValue(int row) const
+{
+    return IsNumber(row) || !m_strings[row].isNull();
+}
+
+bool PathColumn::IsNumber(int row) const
+{
+    return !std::isnan(m_numbers[row]);
+}
+
+double PathColumn::Number(int row) const
+{
+    return m_numbers[row];
+}
+
+QVariant PathColumn::Data(int row) const
+{
+    if (IsNumber(row))
+        return m_numbers[row];
+    if (m_strings[row].isNull())
+        return QVariant();
+    return m_strings[row];
+}
+
+QString PathColumn::DisplayString(int row) const
+{
+    if (IsNumber(row))
+        return QString::number(m_numbers[row], 'g', 15);
+    return m_strings[row];
+}
+
+bool PathColumn::ParseFilter(const QString& text, Filter& filter)
+{
+    QRegularExpressionMatch match = FilterRegex().match(text);
+    if (!match.hasMatch())
+        return false;
+
+    const QString op = match.captured(1);
+    filter.op = (op == "!=") ? Filter::Op::NotEqual :
+                (op == "<") ? Filter::Op::Less :
+                (op == "<=") ? Filter::Op::LessOrEqual :
+                (op == ">") ? Filter::Op::Greater :
+                (op == ">=") ? Filter::Op::GreaterOrEqual :
+                Filter::Op::Equal;
+    filter.operand = match.captured(2);
+    filter.number = filter.operand.toDouble(&filter.isNumber);
+    return true;
+}
+
+bool PathColumn::Matches(int row, const Filter& filter) const
+{
+    if (!HasValue(row))
+        return false;
+
+    if (filter.isNumber)
+    {
+        // Some components log numbers as strings, so try to read those as numbers as well
+        bool isRowNumber = IsNumber(row);
+        double rowNumber = isRowNumber ? m_numbers[row] : m_strings[row].toDouble(&isRowNumber);
+        if (isRowNumber)
+            return Compare(filter.op, rowNumber, filter.number);
+    }
+
+    return Compare(filter.op, DisplayString(row), filter.operand);
+}
+
+QJsonValue PathColumn::Extract(const QJsonObject& event) const
+{
+    QJsonValue value(event);
+    for (const QString& segment : m_segments)
+    {
+        if (value.isObject())
+        {
+            QJsonObject obj = value.toObject();
+            auto iter = obj.constFind(segment);
+            if (iter == obj.constEnd())
+                return QJsonValue(QJsonValue::Undefined);
+            value = iter.value();
+        }
+        else if (value.isArray())
+        {
+            bool isIndex = false;
+            int index = segment.toInt(&isIndex);
+            QJsonArray array = value.toArray();
+            if (!isIndex || index < 0 || index >= array.size())
+                return QJsonValue(QJsonValue::Undefined);
+            value = array.at(index);
+        }
+        else
+        {
+            return QJsonValue(QJsonValue::Undefined);
+        }
+    }
+    return value;
+}
+
+void PathColumn::SetRow(int row, const QJsonObject& event)
+{
+    QJsonValue value = Extract(event);
+    switch (value.type())
+    {
+        case QJsonValue::Undefined:
+            break;
+        case QJsonValue::Double:
+            m_numbers[row] = value.toDouble();
+            break;
+        case QJsonValue::String:
+            m_strings[row] = value.toString();
+            break;
+        case QJsonValue::Bool:
+            m_strings[row] = value.toBool() ? "true" : "false";
+            break;
+        case QJsonValue::Null:
+            m_strings[row] = "null";
+            break;
+        case QJsonValue::Object:
+            m_strings[row] = QString::fromUtf8(QJsonDocument(value.toObject()).toJson(QJsonDocument::Compact));
+            break;
+        case QJsonValue::Array:
+            m_strings[row] = QString::fromUtf8(QJsonDocument(value.toArray()).toJson(QJsonDocument::Compact));
+            break;
+    }
+}
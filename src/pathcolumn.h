@@ -0,0 +1,64 @@
+#ifndef PATHCOLUMN_H
+#define PATHCOLUMN_H
+
+#include <functional>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <vector>
+
+// A column promoted from a JSON path inside the events, like "v.elapsed" or "a.res.alloc".
+// The values are extracted once into typed arrays aligned with the top-level rows, so the
+// column can be displayed, sorted and filtered without going back to the JSON.
+class PathColumn
+{
+public:
+    explicit PathColumn(const QString& path);
+
+    const QString& Path() const;
+    int RowCount() const;
+
+    // eventAt gives the event of a row, and is called from several threads
+    void Build(int count, const std::function<QJsonObject(int)>& eventAt);
+    // Rows are sorted and counted after the insertion
+    void InsertRows(const std::vector<int>& rows, const std::function<QJsonObject(int)>& eventAt);
+    void RemoveRows(int row, int count);
+    void Clear();
+    qint64 MemoryBytes() const;
+
+    bool HasValue(int row) const;
+    bool IsNumber(int row) const;
+    double Number(int row) const;
+    QVariant Data(int row) const;
+    QString DisplayString(int row) const;
+
+    // Filters look like "> 100", "<= 2.5", "= abc" or "!= abc". Numbers are compared as
+    // numbers, everything else as text. Rows without a value never match.
+    struct Filter
+    {
+        enum class Op { Equal, NotEqual, Less, LessOrEqual, Greater, GreaterOrEqual };
+        Op op = Op::Equal;
+        QString operand;
+        // The operand read as a number, when it is one
+        bool isNumber = false;
+        double number = 0;
+    };
+    // Parses a filter once, so it can be matched against every row. False when it is not valid.
+    static bool ParseFilter(const QString& text, Filter& filter);
+    bool Matches(int row, const Filter& filter) const;
+
+private:
+    QJsonValue Extract(const QJsonObject& event) const;
+    void SetRow(int row, const QJsonObject& event);
+
+    QString m_path;
+    QStringList m_segments;
+    // NaN for rows that hold no number
+    std::vector<double> m_numbers;
+    // Text of the values that are not numbers. A null string means the path is missing.
+    std::vector<QString> m_strings;
+};
+
+#endif // PATHCOLUMN_H
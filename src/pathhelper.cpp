@@ -15,6 +15,11 @@ namespace PathHelper
         return GetConfigPath() + "/" + QStringLiteral("filters");
     }
 
+    QString GetIndexConfigPath()
+    {
+        return GetConfigPath() + "/" + QStringLiteral("index");
+    }
+
     QString GetConfigIniPath()
     {
         return GetConfigPath() + "/" + QStringLiteral("tlv.ini");
@@ -1,7 +1,9 @@
 #include "processevent.h"
 
+#include "loadfilter.h"
 #include "options.h"
 #include "pathhelper.h"
+#include "trace.h"
 
 #include <QBitArray>
 #include <QJsonDocument>
@@ -9,8 +11,54 @@
 
 namespace ProcessEvent
 {
-    QJsonObject ProcessLogEventMessage(int index, QString message, const QString& fileName)
+    // Seconds taken by the event, from its activity data or else from the first configured key of
+    // its value. Done once while loading so the Elapsed column needs no walk of the value.
+    static bool FindElapsed(const QJsonObject& event, double& elapsed)
     {
+        QJsonObject artObject = event["a"].toObject();
+        if (artObject.contains("elapsed"))
+        {
+            elapsed = artObject["elapsed"].toDouble();
+            return true;
+        }
+
+        if (!event["v"].isObject())
+            return false;
+
+        Options& options = Options::GetInstance();
+        QJsonObject valueObject = event["v"].toObject();
+        for (const QString& key : options.getElapsedKeys())
+        {
+            auto iter = valueObject.constFind(key);
+            if (iter != valueObject.constEnd())
+            {
+                elapsed = iter.value().toVariant().toDouble();
+                return true;
+            }
+        }
+        for (const QString& key : options.getElapsedMsKeys())
+        {
+            auto iter = valueObject.constFind(key);
+            if (iter != valueObject.constEnd())
+            {
+                elapsed = iter.value().toVariant().toDouble() / 1000;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    QJsonObject ProcessLogEventMessage(int index, QString message, const QString& fileName,
+                                       const LoadFilter* filter)
+    {
+        // Rejected lines are never parsed
+        if (filter)
+        {
+            Trace::SummedScope scope("LoadFilter");
+            if (filter->Rejects(message))
+                return QJsonObject();
+        }
+
         Options& options = Options::GetInstance();
         QStringList m_SkippedText = options.getSkippedText();
         QBitArray m_SkippedState = options.getSkippedState();
@@ -28,14 +76,28 @@ namespace ProcessEvent
         {
             message.insert(1, QString("\"file\": \"%1\",").arg(fileName));
             message.insert(1, QString("\"idx\": %1,").arg(index));
-            QJsonDocument jsonDoc = QJsonDocument::fromJson(message.toUtf8());
-            if (jsonDoc.object().contains("k")
-                    && m_SkippedText.contains(jsonDoc.object()["k"].toString())
-                    && m_SkippedState[m_SkippedText.indexOf(jsonDoc.object()["k"].toString(), 0)])
+            QJsonDocument jsonDoc;
             {
-                jsonDoc = QJsonDocument();
+                Trace::SummedScope scope("ParseJson");
+                jsonDoc = QJsonDocument::fromJson(message.toUtf8());
             }
-            return jsonDoc.object();
+            {
+                Trace::SummedScope scope("SkipCheck");
+                if (jsonDoc.object().contains("k")
+                        && m_SkippedText.contains(jsonDoc.object()["k"].toString())
+                        && m_SkippedState[m_SkippedText.indexOf(jsonDoc.object()["k"].toString(), 0)])
+                {
+                    jsonDoc = QJsonDocument();
+                }
+            }
+
+            QJsonObject obj = jsonDoc.object();
+            double elapsed;
+            if (FindElapsed(obj, elapsed))
+            {
+                obj["elapsed"] = elapsed;
+            }
+            return obj;
         }
     }
 }
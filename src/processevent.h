@@ -4,9 +4,13 @@
 #include <QJsonObject>
 #include <QString>
 
+struct LoadFilter;
+
 namespace ProcessEvent
 {
-    QJsonObject ProcessLogEventMessage(int index, QString message, const QString& fileName);
+    // Returns an empty object for lines that are skipped, or that the filter rejects
+    QJsonObject ProcessLogEventMessage(int index, QString message, const QString& fileName,
+                                       const LoadFilter* filter = nullptr);
 }
 
 #endif // PROCESSEVENT_H
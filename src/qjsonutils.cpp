@@ -1,5 +1,7 @@
 #include "qjsonutils.h"
 
+#include "trace.h"
+
 #include <math.h>
 #include <QMap>
 #include <QString>
@@ -25,6 +27,7 @@ namespace
 
 QString QJsonUtils::Format(const QJsonValue& jsonValue, Notation format, LineFormat lineFormat)
 {
+    Trace::SummedScope scope("FormatValue");
     bool isSingleLine = (lineFormat == LineFormat::SingleLine);
 
     if (jsonValue.isString())
@@ -430,3 +433,43 @@ bool QJsonUtils::IsStructured(const QJsonValue &value)
 {
     return value.isObject() || value.isArray();
 }
+
+qint64 QJsonUtils::EstimatedSize(const QJsonValue& value)
+{
+    // Containers store a header and a 16 byte element per key and per value. Strings that fit in
+    // Latin-1 are stored as 8-bit text, the others as UTF-16.
+    const qint64 ContainerSize = 48;
+    const qint64 ElementSize = 16;
+    auto textSize = [](const QString& text) {
+        for (QChar c : text)
+        {
+            if (c.unicode() > 0xFF)
+                return static_cast<qint64>(text.size()) * 2 + 8;
+        }
+        return static_cast<qint64>(text.size()) + 8;
+    };
+
+    if (value.isString())
+        return textSize(value.toString());
+
+    qint64 size = 0;
+    if (value.isObject())
+    {
+        const QJsonObject object = value.toObject();
+        size += ContainerSize;
+        for (auto iter = object.constBegin(); iter != object.constEnd(); ++iter)
+        {
+            size += 2 * ElementSize + textSize(iter.key()) + EstimatedSize(iter.value());
+        }
+    }
+    else if (value.isArray())
+    {
+        const QJsonArray array = value.toArray();
+        size += ContainerSize;
+        for (const QJsonValue& item : array)
+        {
+            size += ElementSize + EstimatedSize(item);
+        }
+    }
+    return size;
+}
@@ -28,4 +28,8 @@ namespace QJsonUtils
     QString GetNameForNotation(Notation notation);
 
     bool IsStructured(const QJsonValue& value);
+
+    // Approximate heap bytes held by a value: the elements of its objects and arrays, the text of
+    // its keys and strings, and what they nest
+    qint64 EstimatedSize(const QJsonValue& value);
 }
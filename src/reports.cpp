@@ -0,0 +1,367 @@
+#include "reports.h"
+
+#include "parallelutils.h"
+#include "timeutils.h"
+
+#include <cmath>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QStringBuilder>
+#include <QTime>
+
+namespace
+{
+    QString msecsToString(qint64 mseconds)
+    {
+        const qint64 msPerDay = 24 * 60 * 60 * 1000;
+        qint64 days = mseconds / msPerDay;
+        QTime t = QTime(0, 0).addMSecs(mseconds % msPerDay);
+        QString str = (days > 0) ? QString("%1 day(s), ").arg(days) : "";
+        str += QString("%1:%2:%3.%4 h:m:s")
+                .arg(t.hour(), 2, 10, QChar('0'))
+                .arg(t.minute(), 2, 10, QChar('0'))
+                .arg(t.second(), 2, 10, QChar('0'))
+                .arg(t.msec(), 2, 10, QChar('0'));
+        return str;
+    }
+
+    // Whether the formatted value would contain text: a string, key or nested string value contains it
+    bool ValueContains(const QJsonValue& value, const QString& text)
+    {
+        if (value.isString())
+            return value.toString().contains(text);
+
+        if (value.isObject())
+        {
+            const QJsonObject object = value.toObject();
+            for (auto iter = object.constBegin(); iter != object.constEnd(); ++iter)
+            {
+                if (iter.key().contains(text) || ValueContains(iter.value(), text))
+                    return true;
+            }
+        }
+        else if (value.isArray())
+        {
+            for (const QJsonValue& item : value.toArray())
+            {
+                if (ValueContains(item, text))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    void ConvertJsonToStringMap(const QJsonObject& valJson, const QStringList& fields, QMap<QString, QString>& nameValues)
+    {
+        for (const auto& field : fields)
+        {
+            const auto& val = valJson[field];
+            if (val.isDouble())
+            {
+                double intpart;
+                const int decimals = (modf(val.toDouble(), &intpart) == 0) ? 0 : 3;
+                nameValues[field] = QString::number(val.toDouble(), 'f', decimals);
+            }
+            else if (val.isString())
+            {
+                QString strVal = val.toString();
+                strVal.truncate(32000); // Excel cannot handle more than ~32K chars.
+                nameValues[field] = "\"" % strVal.replace("\n", "\\n").replace("\"", "\"\"") % "\"";
+            }
+            else if (val.isObject())
+            {
+                ConvertJsonToStringMap(val.toObject(), fields, nameValues);
+            }
+            else if (!nameValues.contains(field))
+            {
+                nameValues[field] = "";
+            }
+        }
+    }
+
+    void WriteJsonAsCsv(const QJsonObject& valJson, QStringList& fields, QString& outputStr)
+    {
+        // If list of fields is not specified, set it to all fields available in the first event.
+        if (fields.isEmpty())
+        {
+            fields = valJson.keys();
+        }
+
+        QMap<QString, QString> nameValues;
+
+        ConvertJsonToStringMap(valJson, fields, nameValues);
+
+        for (const auto& field : fields)
+        {
+            outputStr += nameValues[field] + ",";
+        }
+        outputStr.truncate(outputStr.size() - 1);
+        outputStr += "\n";
+    }
+}
+
+namespace Reports
+{
+    QString Summary(TreeModel* model)
+    {
+        typedef std::map<QString, int> CounterMap;
+
+        struct SummaryCounter
+        {
+            QString Description;
+            QString Key;
+            QString Value;
+            int Count;
+            std::unique_ptr<CounterMap> SubCounters;
+        };
+
+        QString beginQueryEventKey = "begin-query";
+        for (int i = 0; i < model->rowCount(); i++)
+        {
+            QModelIndex valIndex = model->index(i, COL::Value);
+            QString keyString = model->GetEvent(valIndex)["k"].toString();
+            if (keyString == "begin-query")
+            {
+                break;
+            }
+            else if (keyString == "begin-protocol.query")
+            {
+                beginQueryEventKey = "begin-protocol.query";
+                break;
+            }
+        }
+
+        SummaryCounter counters[] {
+            { "Workbook opened", "command-post", "tabui:open-workbook", 0, nullptr },
+            { "Query batch", "qp-batch-summary", nullptr, 0, nullptr },
+            { "Query", beginQueryEventKey, nullptr, 0, nullptr },
+            { "Query category", beginQueryEventKey, "query-category", 0, std::make_unique<CounterMap>() },
+        };
+        const int counterCount = static_cast<int>(std::size(counters));
+
+        // Each range of rows is counted by its own worker into local counters, merged at the end.
+        // Values are matched on the events themselves, without formatting them.
+        const int rowCount = model->rowCount();
+        QMutex mergeMutex;
+        ParallelUtils::ForRanges(rowCount, [&](int first, int last) {
+            std::vector<int> counts(counterCount, 0);
+            std::vector<CounterMap> subCounts(counterCount);
+            for (int i = first; i < last; i++)
+            {
+                if (model->IsHiddenRow(i))
+                    continue;
+
+                QJsonObject event = model->GetEvent(model->index(i, COL::Value));
+                QString keyString = event["k"].toString();
+                QJsonValue valObj = event["v"];
+                for (int c = 0; c < counterCount; c++)
+                {
+                    const SummaryCounter& counter = counters[c];
+                    // Must match full key string.
+                    if (keyString != counter.Key)
+                        continue;
+
+                    // Simple key only or key-value counter.
+                    if (counter.Value.isNull() || ValueContains(valObj, counter.Value))
+                    {
+                        counts[c]++;
+                    }
+
+                    // Sub-counters: match counter.Value with the key part of "v" key-value pairs,
+                    // and bucket-count the different values.
+                    if (counter.SubCounters && valObj.isObject())
+                    {
+                        QJsonObject json = valObj.toObject();
+                        auto subValue = json.constFind(counter.Value);
+                        if (subValue != json.constEnd())
+                        {
+                            subCounts[c][subValue.value().toString()]++;
+                        }
+                    }
+                }
+            }
+
+            QMutexLocker locker(&mergeMutex);
+            for (int c = 0; c < counterCount; c++)
+            {
+                counters[c].Count += counts[c];
+                for (const auto& sc : subCounts[c])
+                {
+                    (*counters[c].SubCounters)[sc.first] += sc.second;
+                }
+            }
+        });
+
+        QString summaryText;
+        if (rowCount > 0)
+        {
+            auto firstIdx = model->index(0, COL::Time);
+            auto lastIdx = model->index(model->rowCount() - 1, COL::Time);
+            QString firstTimestamp = model->data(firstIdx, Qt::DisplayRole).toString();
+            QString lastTimestamp = model->data(lastIdx, Qt::DisplayRole).toString();
+            auto firstDT = model->data(firstIdx, Qt::UserRole).toLongLong();
+            auto lastDT = model->data(lastIdx, Qt::UserRole).toLongLong();
+            // Timestamps are in microseconds
+            auto diff = (lastDT - firstDT) / 1000;
+            summaryText += QString("Begin: %1\nEnd: %2\nSpan: %3\n\n")
+                    .arg(firstTimestamp).arg(lastTimestamp).arg(msecsToString(diff));
+        }
+
+        summaryText += "Number of";
+        summaryText += QString("\n    Event: %L1").arg(rowCount - model->HiddenRowCount());
+        for (const SummaryCounter& counter : counters)
+        {
+            summaryText += QString("\n    %1: %L2").arg(counter.Description).arg(counter.Count);
+            if (counter.SubCounters && counter.SubCounters->size())
+            {
+                for (const auto& sc : *counter.SubCounters)
+                {
+                    int subCount = sc.second;
+                    float subCountPercent = subCount * 100.0 / counter.Count;
+                    summaryText += QString("\n    - %1: %L2 (%3%)").arg(sc.first).arg(subCount, 3).arg(subCountPercent, 0, 'f', 1);
+                }
+            }
+        }
+
+        return summaryText;
+    }
+
+    std::vector<CsvFile> QueryCsvFiles(TreeModel* model)
+    {
+        QString outputQuery;
+        QString outputTempTable;
+        QString outputProtocol;
+        QString outputFedTempTable;
+        QString outputElapsedEvent;
+        QStringList fieldsQuery{"cols", "elapsed", "protocol-id", "query", "query-category", "query-hash", "rows"};
+        QStringList fieldsTempTable{"elapsed",    "elapsed-create", "elapsed-insert",    "num-columns",
+                                    "num-tuples", "protocol-id",    "source-query-hash", "tablename"};
+        QStringList fieldsProtocol{"id", "created-elapsed", "attributes", "class", "dbname", "server"};
+        QStringList fieldsFedTempTable{"query-hash", "table-name"};
+        QStringList fieldsElapsedEvent{"line-id", "time", "elapsed", "begin", "file", "pid", "event", "value"};
+
+        const int rowCount = model->rowCount();
+        for (int i = 0; i < rowCount; i++)
+        {
+            if (model->IsHiddenRow(i))
+                continue;
+
+            QModelIndex valIndex = model->index(i, COL::Value);
+            QJsonObject event = model->GetEvent(valIndex);
+            QString keyString = event["k"].toString();
+
+            auto elapsed = model->index(i, COL::Elapsed).data().toDouble();
+            if (elapsed != 0.0)
+            {
+                auto strId = model->index(i, COL::ID).data().toString();
+                auto strTime = event["ts"].toString();
+                auto strElapsed = QString::number(elapsed, 'f', 3);
+                auto beginTime = TimeUtils::ToLocalEpochMSecs(model->index(i, COL::Time).data(Qt::UserRole).toLongLong()) - (elapsed * 1000);
+                auto strFile = model->index(i, COL::File).data().toString();
+                auto strPid = model->index(i, COL::PID).data().toString();
+                auto strValue = model->GetValueFullString(valIndex);
+                if (strValue.size() > 3000)
+                {
+                    strValue.truncate(3000);
+                    strValue += "...";
+                }
+                strValue.replace("\n", "\\n").replace("\"", "\"\"");
+                outputElapsedEvent += QString("%1,\"%2\",%3,%4,\"%5\",%6,\"%7\",\"%8\"\n")
+                                          .arg(
+                                              strId, strTime, strElapsed, QString::number(beginTime, 'f', 0), strFile,
+                                              strPid, keyString, strValue);
+            }
+
+            if (keyString == "end-query")
+            {
+                const QJsonObject& valJson = event["v"].toObject();
+                WriteJsonAsCsv(valJson, fieldsQuery, outputQuery);
+
+                // For federated queries, parsed out all the temp tables used and create a separate list.
+                QString queryText = valJson["query"].toString();
+                if (queryText.contains("FQ_Temp_"))
+                {
+                    QRegularExpression regex;
+                    if (queryText.startsWith("(restrict"))
+                    {
+                        regex.setPattern("table (.*?)\\)");
+                    }
+                    else if (queryText.startsWith("SELECT "))
+                    {
+                        regex.setPattern("\"(#Tableau_.*?)\" ");
+                    }
+                    else
+                    {
+                        continue;
+                    }
+
+                    QString queryHash = QString::number(valJson["query-hash"].toDouble(), 'f', 0);
+                    QRegularExpressionMatchIterator i = regex.globalMatch(queryText);
+                    while (i.hasNext())
+                    {
+                        QRegularExpressionMatch match = i.next();
+                        QString tableName = match.captured(1);
+                        if (!tableName.startsWith("["))
+                        {
+                            // Hyper does not use square brackets for table names, but the table names
+                            // we log in sql-temp-table events have them.
+                            tableName = "[" % tableName % "]";
+                        }
+                        outputFedTempTable += queryHash % ",\"" % tableName % "\"\n";
+                    }
+                }
+            }
+            else if (keyString == "end-sql-temp-table-tuples-create")
+            {
+                WriteJsonAsCsv(event["v"].toObject(), fieldsTempTable, outputTempTable);
+            }
+            else if (keyString == "construct-protocol")
+            {
+                WriteJsonAsCsv(event["v"].toObject(), fieldsProtocol, outputProtocol);
+            }
+        }
+
+        if (outputElapsedEvent.isEmpty())
+            return std::vector<CsvFile>();
+
+        return {
+            { "TLV_Query.csv", fieldsQuery, outputQuery },
+            { "TLV_FedTempTable.csv", fieldsFedTempTable, outputFedTempTable },
+            { "TLV_TempTable.csv", fieldsTempTable, outputTempTable },
+            { "TLV_Protocol.csv", fieldsProtocol, outputProtocol },
+            { "TLV_ElapsedEvent.csv", fieldsElapsedEvent, outputElapsedEvent },
+        };
+    }
+
+    bool SaveCsvFiles(const std::vector<CsvFile>& files, const QString& folder, QString& error)
+    {
+        QDir dir(folder);
+        if (!dir.exists() && !dir.mkpath("."))
+        {
+            error = QString("Error creating directory %1").arg(dir.path());
+            return false;
+        }
+
+        for (const CsvFile& csvFile : files)
+        {
+            QFile file(dir.filePath(csvFile.fileName));
+            if (!file.open(QIODevice::WriteOnly))
+            {
+                error = QString("Error writing file %1").arg(file.fileName());
+                return false;
+            }
+            QString output = csvFile.fields.join(',') + "\n" + csvFile.content;
+            file.write(output.toUtf8());
+        }
+        return true;
+    }
+}
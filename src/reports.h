@@ -0,0 +1,31 @@
+#ifndef REPORTS_H
+#define REPORTS_H
+
+#include "treemodel.h"
+
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+// Reports built from the rows of a model that are not hidden, shared by the GUI and the batch mode
+namespace Reports
+{
+    // Time span of the rows and counts of workbook, query and query category events.
+    // The rows are counted on all cores.
+    QString Summary(TreeModel* model);
+
+    struct CsvFile
+    {
+        QString fileName;
+        QStringList fields;
+        QString content;
+    };
+
+    // Queries, temp tables, protocols and events with an elapsed time, as read by the query workbooks.
+    // Empty when no row has an elapsed time.
+    std::vector<CsvFile> QueryCsvFiles(TreeModel* model);
+    // Writes the files to folder, creating it when needed. On failure, error says what couldn't be written.
+    bool SaveCsvFiles(const std::vector<CsvFile>& files, const QString& folder, QString& error);
+}
+
+#endif // REPORTS_H
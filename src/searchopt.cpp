@@ -13,7 +13,7 @@ SearchOpt::SearchOpt() :
 {
 }
 
-bool SearchOpt::HasMatch(QString value)
+bool SearchOpt::HasMatch(const QString& value) const
 {
     switch (m_mode) {
         case SearchMode::Equals:
@@ -20,7 +20,7 @@ class SearchOpt
 {
 public:
     SearchOpt();
-    bool HasMatch(QString value);
+    bool HasMatch(const QString& value) const;
     QJsonObject ToJson();
     void FromJson(const QJsonObject& json);
 
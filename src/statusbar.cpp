@@ -2,10 +2,13 @@
 
 StatusBar::StatusBar(QMainWindow* parent) :
     m_qbar(parent->statusBar()),
-    m_statusLabel(new QLabel(parent))
+    m_statusLabel(new QLabel(parent)),
+    m_memoryLabel(new QLabel(parent))
 {
     m_statusLabel->setContentsMargins(0, 0, 8, 0);
+    m_memoryLabel->setContentsMargins(0, 0, 8, 0);
     m_qbar->addPermanentWidget(m_statusLabel);
+    m_qbar->addPermanentWidget(m_memoryLabel);
 }
 
 void StatusBar::ShowMessage(const QString& message, int timeout)
@@ -17,3 +20,9 @@ void StatusBar::SetRightLabelText(const QString& text)
 {
     m_statusLabel->setText(text);
 }
+
+void StatusBar::SetMemoryText(const QString& text, const QString& toolTip)
+{
+    m_memoryLabel->setText(text);
+    m_memoryLabel->setToolTip(toolTip);
+}
@@ -9,10 +9,12 @@ public:
     StatusBar(QMainWindow* parent);
     void ShowMessage(const QString& message, int timeout);
     void SetRightLabelText(const QString& text);
+    void SetMemoryText(const QString& text, const QString& toolTip);
 
 private:
     QStatusBar *m_qbar;
     QLabel *m_statusLabel;
+    QLabel *m_memoryLabel;
 };
 
 #endif // STATUSBAR_H
@@ -0,0 +1,119 @@
+# Sources shared by the viewer and the benchmark, everything but main.cpp
+
+QT       += concurrent
+QT       += core gui
+QT       += network
+QT       += webenginewidgets
+QT       += widgets
+
+# Compressed logs are inflated with zlib, Qt's own copy where the system has none
+unix: LIBS += -lz
+win32: QT += zlib-private
+# zstd compressed logs are read when libzstd is installed
+packagesExist(libzstd) {
+    DEFINES += TLV_ZSTD
+    LIBS += -lzstd
+}
+
+CONFIG += c++17
+
+INCLUDEPATH += $$PWD
+
+FORMS      += \
+    $$PWD/filtertab.ui \
+    $$PWD/finddlg.ui \
+    $$PWD/highlightdlg.ui \
+    $$PWD/loadfilterdlg.ui \
+    $$PWD/logtab.ui \
+    $$PWD/mainwindow.ui \
+    $$PWD/optionsdlg.ui \
+    $$PWD/savefilterdialog.ui \
+    $$PWD/timerangedlg.ui \
+    $$PWD/valuedlg.ui 
+
+HEADERS    += \
+    $$PWD/batchmode.h \
+    $$PWD/colorlibrary.h \
+    $$PWD/column.h \
+    $$PWD/columnindex.h \
+    $$PWD/compressedfile.h \
+    $$PWD/eventindex.h \
+    $$PWD/filtertab.h \
+    $$PWD/finddlg.h \
+    $$PWD/highlightdlg.h \
+    $$PWD/highlightoptions.h \
+    $$PWD/indexcache.h \
+    $$PWD/loadfilter.h \
+    $$PWD/loadfilterdlg.h \
+    $$PWD/logreader.h \
+    $$PWD/logtab.h \
+    $$PWD/logtree.h \
+    $$PWD/mainwindow.h \
+    $$PWD/options.h \
+    $$PWD/optionsdlg.h \
+    $$PWD/pagedevents.h \
+    $$PWD/parallelutils.h \
+    $$PWD/pathcolumn.h \
+    $$PWD/pathhelper.h \
+    $$PWD/processevent.h \
+    $$PWD/reports.h \
+    $$PWD/savefilterdialog.h \
+    $$PWD/searchopt.h \
+    $$PWD/statusbar.h \
+    $$PWD/tokenizer.h \
+    $$PWD/treeitem.h \
+    $$PWD/treemodel.h \
+    $$PWD/valuedlg.h \
+    $$PWD/vectorutils.h \
+    $$PWD/zoomabletreeview.h \
+    $$PWD/ziparchive.h \
+    $$PWD/themeutils.h \
+    $$PWD/timeindex.h \
+    $$PWD/timerangedlg.h \
+    $$PWD/timeutils.h \
+    $$PWD/trace.h \
+    $$PWD/theme.h \
+    $$PWD/qjsonutils.h
+
+SOURCES    += \
+    $$PWD/batchmode.cpp \
+    $$PWD/colorlibrary.cpp \
+    $$PWD/columnindex.cpp \
+    $$PWD/compressedfile.cpp \
+    $$PWD/eventindex.cpp \
+    $$PWD/filtertab.cpp \
+    $$PWD/finddlg.cpp \
+    $$PWD/highlightdlg.cpp \
+    $$PWD/highlightoptions.cpp \
+    $$PWD/indexcache.cpp \
+    $$PWD/loadfilter.cpp \
+    $$PWD/loadfilterdlg.cpp \
+    $$PWD/logreader.cpp \
+    $$PWD/logtab.cpp \
+    $$PWD/logtree.cpp \
+    $$PWD/mainwindow.cpp \
+    $$PWD/options.cpp \
+    $$PWD/optionsdlg.cpp \
+    $$PWD/pagedevents.cpp \
+    $$PWD/pathcolumn.cpp \
+    $$PWD/pathhelper.cpp \
+    $$PWD/processevent.cpp \
+    $$PWD/reports.cpp \
+    $$PWD/savefilterdialog.cpp \
+    $$PWD/searchopt.cpp \
+    $$PWD/statusbar.cpp \
+    $$PWD/tokenizer.cpp \
+    $$PWD/treeitem.cpp \
+    $$PWD/treemodel.cpp \
+    $$PWD/valuedlg.cpp \
+    $$PWD/zoomabletreeview.cpp \
+    $$PWD/ziparchive.cpp \
+    $$PWD/themeutils.cpp \
+    $$PWD/timeindex.cpp \
+    $$PWD/timerangedlg.cpp \
+    $$PWD/timeutils.cpp \
+    $$PWD/trace.cpp \
+    $$PWD/theme.cpp \
+    $$PWD/qjsonutils.cpp
+
+RESOURCES  += $$PWD/resources.qrc
@@ -0,0 +1,279 @@
+#include "timeindex.h"
+
+#include "parallelutils.h"
+#include "indexcache.h"
+#include "processevent.h"
+#include "timeutils.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace
+{
+    const quint32 Magic = 0x544C5654; // "TLVT"
+    const quint32 Version = 1;
+    // Tableau logs start with "ts", so there is no need to look through a whole long line for it
+    const qint64 MaxTimestampOffset = 256;
+
+    QString IndexPath(const QString& logPath)
+    {
+        return IndexCache::IndexPath(logPath, "tlvtime");
+    }
+
+    // Reads the "ts" of a log line without parsing the rest of the JSON
+    bool LineTimestamp(const char* line, qint64 length, qint64& usecs)
+    {
+        QByteArray text = QByteArray::fromRawData(line, std::min(length, MaxTimestampOffset));
+        qsizetype pos = text.indexOf("\"ts\"");
+        if (pos < 0)
+            return false;
+
+        pos += 4;
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == ':'))
+        {
+            pos++;
+        }
+        if (pos >= text.size() || text[pos] != '"')
+            return false;
+
+        qsizetype close = text.indexOf('"', ++pos);
+        if (close < 0)
+            return false;
+        return TimeUtils::ParseTimestamp(QString::fromLatin1(text.constData() + pos, close - pos), usecs);
+    }
+
+    bool IsBlank(const char* line, qint64 length)
+    {
+        for (qint64 i = 0; i < length; i++)
+        {
+            if (!std::isspace(static_cast<unsigned char>(line[i])))
+                return false;
+        }
+        return true;
+    }
+
+    qint64 LineEnd(const char* text, qint64 pos, qint64 size)
+    {
+        const void* newline = std::memchr(text + pos, '\n', static_cast<size_t>(size - pos));
+        return newline ? static_cast<const char*>(newline) - text : size;
+    }
+
+    std::vector<TimeIndex::Sample> SampleFile(const char* text, qint64 size)
+    {
+        std::vector<TimeIndex::Sample> samples;
+        for (qint64 pos = 0; pos < size; pos += TimeIndex::SampleInterval)
+        {
+            // The first whole line at or after pos, then the first one with a timestamp before the next sample
+            qint64 lineStart = (pos == 0) ? 0 : LineEnd(text, pos - 1, size) + 1;
+            qint64 limit = std::min(size, pos + TimeIndex::SampleInterval);
+            if (!samples.empty() && lineStart <= samples.back().offset)
+                continue;
+
+            while (lineStart < limit)
+            {
+                qint64 lineEnd = LineEnd(text, lineStart, size);
+                qint64 time;
+                if (LineTimestamp(text + lineStart, lineEnd - lineStart, time))
+                {
+                    samples.push_back({lineStart, time});
+                    break;
+                }
+                lineStart = lineEnd + 1;
+            }
+        }
+
+        // Also the last timestamped line, so the samples span the whole file
+        qint64 floor = samples.empty() ? 0 : samples.back().offset + 1;
+        qint64 lineEnd = size;
+        while (lineEnd > floor)
+        {
+            qint64 lineStart = lineEnd - 1;
+            while (lineStart > 0 && text[lineStart - 1] != '\n')
+            {
+                lineStart--;
+            }
+            qint64 time;
+            if (lineStart >= floor && LineTimestamp(text + lineStart, lineEnd - lineStart, time))
+            {
+                samples.push_back({lineStart, time});
+                break;
+            }
+            lineEnd = lineStart - 1;
+        }
+        return samples;
+    }
+
+    bool ReadSamples(const QString& logPath, const QFileInfo& logInfo, std::vector<TimeIndex::Sample>& samples)
+    {
+        QFile file(IndexPath(logPath));
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+
+        QDataStream stream(&file);
+        quint32 magic = 0;
+        quint32 version = 0;
+        stream >> magic >> version;
+        if (magic != Magic || version != Version)
+            return false;
+
+        qint64 size = 0;
+        qint64 modified = 0;
+        qint64 interval = 0;
+        quint32 count = 0;
+        stream >> size >> modified >> interval >> count;
+        if (stream.status() != QDataStream::Ok ||
+            size != logInfo.size() ||
+            modified != logInfo.lastModified().toMSecsSinceEpoch() ||
+            interval != TimeIndex::SampleInterval ||
+            count > size / interval + 2)
+        {
+            return false;
+        }
+
+        samples.resize(count);
+        qint64 previousOffset = -1;
+        for (auto& sample : samples)
+        {
+            stream >> sample.offset >> sample.time;
+            if (sample.offset <= previousOffset || sample.offset >= size)
+                return false;
+            previousOffset = sample.offset;
+        }
+        if (stream.status() != QDataStream::Ok)
+            return false;
+
+        file.close();
+        IndexCache::Touch(file.fileName());
+        return true;
+    }
+
+    void SaveSamples(const QString& logPath, const QFileInfo& logInfo, const std::vector<TimeIndex::Sample>& samples)
+    {
+        QDir().mkpath(QFileInfo(IndexPath(logPath)).absolutePath());
+        QSaveFile file(IndexPath(logPath));
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            qWarning() << "Cannot write the time index of" << logPath;
+            return;
+        }
+
+        QDataStream stream(&file);
+        stream << Magic << Version
+               << logInfo.size() << logInfo.lastModified().toMSecsSinceEpoch()
+               << TimeIndex::SampleInterval << static_cast<quint32>(samples.size());
+        for (const auto& sample : samples)
+        {
+            stream << sample.offset << sample.time;
+        }
+        if (file.commit())
+            IndexCache::Prune();
+    }
+}
+
+namespace TimeIndex
+{
+    std::vector<Sample> GetSamples(const QString& logPath)
+    {
+        QFileInfo logInfo(logPath);
+        std::vector<Sample> samples;
+        if (ReadSamples(logPath, logInfo, samples))
+            return samples;
+
+        samples.clear();
+        QFile logFile(logPath);
+        if (!logFile.open(QIODevice::ReadOnly) || logFile.size() == 0)
+            return samples;
+        uchar* data = logFile.map(0, logFile.size());
+        if (!data)
+            return samples;
+
+        samples = SampleFile(reinterpret_cast<const char*>(data), logFile.size());
+        logFile.unmap(data);
+        SaveSamples(logPath, logInfo, samples);
+        return samples;
+    }
+
+    bool ReadWindow(const QString& logPath, const QString& fileName, const std::vector<Sample>& samples,
+                    qint64 start, qint64 end, QList<QJsonObject>& events, int& skippedCount)
+    {
+        Trace::Scope scope("ReadWindow", logPath);
+        QFile logFile(logPath);
+        if (!logFile.open(QIODevice::ReadOnly))
+            return false;
+        if (samples.empty())
+            return true;
+
+        const qint64 size = logFile.size();
+        uchar* data = logFile.map(0, size);
+        if (!data)
+            return false;
+        const char* text = reinterpret_cast<const char*>(data);
+
+        // Threads write their lines slightly out of order, so reading starts a sample before the last
+        // one that is before the window, and stops a sample after the first one past it
+        size_t firstSample = std::lower_bound(samples.begin(), samples.end(), start,
+                                        [](const Sample& sample, qint64 time) { return sample.time < time; }) - samples.begin();
+        size_t lastSample = std::upper_bound(samples.begin(), samples.end(), end,
+                                       [](qint64 time, const Sample& sample) { return time < sample.time; }) - samples.begin();
+        qint64 beginOffset = (firstSample >= 2) ? samples[firstSample - 2].offset : 0;
+        qint64 endOffset = (lastSample + 1 < samples.size()) ? samples[lastSample + 1].offset : size;
+        endOffset = std::min(endOffset, size);
+
+        // Find the lines of the window, then parse them on all cores
+        struct Line
+        {
+            qint64 offset;
+            qint64 length;
+            int index;
+        };
+        std::vector<Line> lines;
+        int lineCount = 0;
+        bool isInWindow = false;
+        for (qint64 pos = beginOffset; pos < endOffset;)
+        {
+            qint64 lineEnd = LineEnd(text, pos, size);
+            qint64 length = lineEnd - pos;
+            if (!IsBlank(text + pos, length))
+            {
+                lineCount++;
+                qint64 time;
+                if (LineTimestamp(text + pos, length, time))
+                    isInWindow = (time >= start && time <= end);
+                if (isInWindow)
+                    lines.push_back({pos, length, lineCount});
+            }
+            pos = lineEnd + 1;
+        }
+
+        const int count = static_cast<int>(lines.size());
+        QList<QJsonObject> parsed(count);
+        QJsonObject* out = parsed.data();
+        ParallelUtils::ForRanges(count, [&](int first, int last) {
+            for (int i = first; i < last; i++)
+            {
+                QByteArray line = QByteArray::fromRawData(text + lines[i].offset, lines[i].length).trimmed();
+                out[i] = ProcessEvent::ProcessLogEventMessage(lines[i].index, QString::fromUtf8(line), fileName);
+            }
+        }, 256);
+        logFile.unmap(data);
+
+        events.reserve(events.size() + count);
+        for (QJsonObject& event : parsed)
+        {
+            if (event.isEmpty())
+                skippedCount++;
+            else
+                events.append(std::move(event));
+        }
+        return true;
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef TIMEINDEX_H
+#define TIMEINDEX_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <vector>
+
+// Sparse index of the timestamps of a log, kept in the config directory next to the event indexes.
+// It samples one line every SampleInterval bytes, so a time window of a huge log can be found with
+// a binary search and read without touching the rest of the file.
+namespace TimeIndex
+{
+    // A 20 GB log has about 20 thousand samples
+    const qint64 SampleInterval = 1024 * 1024;
+
+    struct Sample
+    {
+        // Start of the first line with a timestamp after the sampled position
+        qint64 offset;
+        // Microseconds since the epoch
+        qint64 time;
+    };
+
+    // Samples of logPath in file order. They come from the index when the file didn't change since
+    // it was written, otherwise the file is sampled again and the index saved.
+    std::vector<Sample> GetSamples(const QString& logPath);
+
+    // Fills events with the lines of logPath that have a timestamp in [start, end]. Lines without
+    // a timestamp go with the timestamped line before them. Only the part of the file between the
+    // samples around the window is read, and the "idx" of the events counts from there.
+    bool ReadWindow(const QString& logPath, const QString& fileName, const std::vector<Sample>& samples,
+                    qint64 start, qint64 end, QList<QJsonObject>& events, int& skippedCount);
+}
+
+#endif // TIMEINDEX_H
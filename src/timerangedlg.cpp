@@ -0,0 +1,58 @@
+#include "timerangedlg.h"
+#include "ui_timerangedlg.h"
+
+#include "timeutils.h"
+
+#include <QPushButton>
+
+TimeRangeDlg::TimeRangeDlg(QWidget *parent, const QString& fileName, qint64 firstTime, qint64 lastTime) :
+    QDialog(parent),
+    ui(new Ui::TimeRangeDlg)
+{
+    ui->setupUi(this);
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    // The logs carry no time zone, so the times are shown as they are written in the log
+    QDateTime first = TimeUtils::ToDateTime(firstTime);
+    QDateTime last = TimeUtils::ToDateTime(lastTime + 999);
+    for (QDateTimeEdit* edit : {ui->fromEdit, ui->toEdit})
+    {
+        edit->setTimeSpec(Qt::UTC);
+        edit->setDateTimeRange(first, last);
+    }
+    ui->fromEdit->setDateTime(first);
+    ui->toEdit->setDateTime(last);
+    ui->spanLabel->setText(QString("%1 has events from %2 to %3")
+                           .arg(fileName, TimeUtils::FormatDateTime(firstTime), TimeUtils::FormatDateTime(lastTime)));
+}
+
+TimeRangeDlg::~TimeRangeDlg()
+{
+    delete ui;
+}
+
+qint64 TimeRangeDlg::Start() const
+{
+    return ui->fromEdit->dateTime().toMSecsSinceEpoch() * 1000;
+}
+
+qint64 TimeRangeDlg::End() const
+{
+    // The edits stop at milliseconds, so the window takes in the whole last millisecond
+    return ui->toEdit->dateTime().toMSecsSinceEpoch() * 1000 + 999;
+}
+
+void TimeRangeDlg::on_fromEdit_dateTimeChanged()
+{
+    UpdateOkButton();
+}
+
+void TimeRangeDlg::on_toEdit_dateTimeChanged()
+{
+    UpdateOkButton();
+}
+
+void TimeRangeDlg::UpdateOkButton()
+{
+    ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(ui->fromEdit->dateTime() <= ui->toEdit->dateTime());
+}
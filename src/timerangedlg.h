@@ -0,0 +1,32 @@
+#ifndef TIMERANGEDLG_H
+#define TIMERANGEDLG_H
+
+#include <QDialog>
+
+namespace Ui {
+class TimeRangeDlg;
+}
+
+// Picks the time window of a log to open. Times are microseconds since the epoch, like the events.
+class TimeRangeDlg : public QDialog
+{
+    Q_OBJECT
+
+public:
+    TimeRangeDlg(QWidget *parent, const QString& fileName, qint64 firstTime, qint64 lastTime);
+    ~TimeRangeDlg();
+
+    qint64 Start() const;
+    qint64 End() const;
+
+private slots:
+    void on_fromEdit_dateTimeChanged();
+    void on_toEdit_dateTimeChanged();
+
+private:
+    void UpdateOkButton();
+
+    Ui::TimeRangeDlg *ui;
+};
+
+#endif // TIMERANGEDLG_H
@@ -0,0 +1,184 @@
+#include "timeutils.h"
+
+namespace
+{
+    // Reads a fixed number of digits at pos. Returns false on anything else.
+    bool ReadDigits(const QChar* data, int pos, int count, int& value)
+    {
+        value = 0;
+        for (int i = pos; i < pos + count; i++)
+        {
+            ushort digit = data[i].unicode() - '0';
+            if (digit > 9)
+                return false;
+            value = value * 10 + digit;
+        }
+        return true;
+    }
+
+    // Days since 1970-01-01 of a civil date, from Howard Hinnant's date algorithms
+    qint64 DaysFromCivil(int year, int month, int day)
+    {
+        year -= month <= 2;
+        const qint64 era = (year >= 0 ? year : year - 399) / 400;
+        const int yearOfEra = static_cast<int>(year - era * 400);
+        const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    // Inverse of DaysFromCivil
+    void CivilFromDays(qint64 days, int& year, int& month, int& day)
+    {
+        days += 719468;
+        const qint64 era = (days >= 0 ? days : days - 146096) / 146097;
+        const int dayOfEra = static_cast<int>(days - era * 146097);
+        const int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const int monthIndex = (5 * dayOfYear + 2) / 153;
+        day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+        month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+        year = static_cast<int>(yearOfEra + era * 400) + (month <= 2);
+    }
+
+    // Writes value as exactly count digits and returns the position after them
+    int WriteDigits(QChar* buffer, int pos, qint64 value, int count)
+    {
+        for (int i = pos + count - 1; i >= pos; i--)
+        {
+            buffer[i] = QChar('0' + static_cast<int>(value % 10));
+            value /= 10;
+        }
+        return pos + count;
+    }
+
+    // Writes hh:mm:ss.zzz of a millisecond count
+    int WriteTimeOfDay(QChar* buffer, int pos, qint64 msecs, int hourDigits)
+    {
+        pos = WriteDigits(buffer, pos, msecs / 3600000, hourDigits);
+        buffer[pos++] = ':';
+        pos = WriteDigits(buffer, pos, msecs / 60000 % 60, 2);
+        buffer[pos++] = ':';
+        pos = WriteDigits(buffer, pos, msecs / 1000 % 60, 2);
+        buffer[pos++] = '.';
+        return WriteDigits(buffer, pos, msecs % 1000, 3);
+    }
+
+    qint64 FloorDiv(qint64 value, qint64 divisor)
+    {
+        return (value >= 0) ? value / divisor : (value - divisor + 1) / divisor;
+    }
+}
+
+namespace TimeUtils
+{
+    bool ParseTimestamp(const QString& timestamp, qint64& usecs)
+    {
+        // yyyy-MM-ddTHH:mm:ss
+        const int SecondsLength = 19;
+        const int size = timestamp.size();
+        if (size < SecondsLength)
+            return false;
+
+        const QChar* data = timestamp.constData();
+        if (data[4] != '-' || data[7] != '-' || data[10] != 'T' || data[13] != ':' || data[16] != ':')
+            return false;
+
+        int year, month, day, hour, minute, second;
+        if (!ReadDigits(data, 0, 4, year) || !ReadDigits(data, 5, 2, month) || !ReadDigits(data, 8, 2, day) ||
+            !ReadDigits(data, 11, 2, hour) || !ReadDigits(data, 14, 2, minute) || !ReadDigits(data, 17, 2, second))
+            return false;
+
+        if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+            return false;
+
+        int fraction = 0;
+        if (size > SecondsLength)
+        {
+            const int digitCount = size - SecondsLength - 1;
+            if (data[SecondsLength] != '.' || digitCount < 1 || digitCount > 9)
+                return false;
+
+            int fractionDigits = 0;
+            int scale = 1000000;
+            for (int i = 0; i < digitCount; i++)
+            {
+                int digit;
+                if (!ReadDigits(data, SecondsLength + 1 + i, 1, digit))
+                    return false;
+                if (fractionDigits < 6)
+                {
+                    scale /= 10;
+                    fraction += digit * scale;
+                    fractionDigits++;
+                }
+            }
+        }
+
+        qint64 seconds = DaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+        usecs = seconds * 1000000 + fraction;
+        return true;
+    }
+
+    QDateTime ToDateTime(qint64 usecs)
+    {
+        // Round towards negative infinity so times before the epoch keep the right millisecond
+        return QDateTime::fromMSecsSinceEpoch(FloorDiv(usecs, 1000), Qt::UTC);
+    }
+
+    qint64 ToLocalEpochMSecs(qint64 usecs)
+    {
+        QDateTime utc = ToDateTime(usecs);
+        return QDateTime(utc.date(), utc.time(), Qt::LocalTime).toMSecsSinceEpoch();
+    }
+
+    QString FormatDateTime(qint64 usecs)
+    {
+        const qint64 MSecsPerDay = 86400000;
+        qint64 msecs = FloorDiv(usecs, 1000);
+        qint64 days = FloorDiv(msecs, MSecsPerDay);
+        int year, month, day;
+        CivilFromDays(days, year, month, day);
+
+        QChar buffer[25];
+        int pos = WriteDigits(buffer, 0, month, 2);
+        buffer[pos++] = '/';
+        pos = WriteDigits(buffer, pos, day, 2);
+        buffer[pos++] = '/';
+        pos = WriteDigits(buffer, pos, year, 4);
+        buffer[pos++] = ' ';
+        buffer[pos++] = '-';
+        buffer[pos++] = ' ';
+        pos = WriteTimeOfDay(buffer, pos, msecs - days * MSecsPerDay, 2);
+        return QString(buffer, pos);
+    }
+
+    QString FormatTime(qint64 usecs)
+    {
+        const qint64 MSecsPerDay = 86400000;
+        qint64 msecs = FloorDiv(usecs, 1000);
+
+        QChar buffer[12];
+        int pos = WriteTimeOfDay(buffer, 0, msecs - FloorDiv(msecs, MSecsPerDay) * MSecsPerDay, 2);
+        return QString(buffer, pos);
+    }
+
+    QString FormatDuration(qint64 usecs)
+    {
+        qint64 msecs = usecs / 1000;
+        bool isNegative = msecs < 0;
+        msecs = isNegative ? -msecs : msecs;
+        int hourDigits = 2;
+        for (qint64 hours = msecs / 3600000; hours >= 100; hours /= 10)
+        {
+            hourDigits++;
+        }
+
+        QChar buffer[32];
+        int pos = 0;
+        if (isNegative)
+            buffer[pos++] = '-';
+        pos = WriteTimeOfDay(buffer, pos, msecs, hourDigits);
+        return QString(buffer, pos);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef TIMEUTILS_H
+#define TIMEUTILS_H
+
+#include <QDateTime>
+#include <QString>
+
+// Event timestamps are kept as microseconds since the epoch. The logs carry no time zone,
+// so the timestamps are read as UTC and only converted to a QDateTime for display.
+namespace TimeUtils
+{
+    // Parses "yyyy-MM-ddTHH:mm:ss" with an optional fraction of up to 9 digits (zzz and zzzzzz
+    // in practice). Digits beyond microseconds are ignored.
+    bool ParseTimestamp(const QString& timestamp, qint64& usecs);
+    QDateTime ToDateTime(qint64 usecs);
+    // Milliseconds since the epoch of the timestamp read as local time, like QDateTime::fromString does
+    qint64 ToLocalEpochMSecs(qint64 usecs);
+
+    // Same output as QDateTime::toString with "MM/dd/yyyy - hh:mm:ss.zzz" and "hh:mm:ss.zzz",
+    // without going through QDateTime or the format parser.
+    QString FormatDateTime(qint64 usecs);
+    QString FormatTime(qint64 usecs);
+    // Signed "hh:mm:ss.zzz" duration, hours can go past 24
+    QString FormatDuration(qint64 usecs);
+}
+
+#endif // TIMEUTILS_H
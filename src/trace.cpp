@@ -0,0 +1,293 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+namespace
+{
+    struct TraceScope
+    {
+        const char* name;
+        qint64 startNSecs;
+        qint64 endNSecs;
+        QString detail;
+    };
+
+    struct Sum
+    {
+        const char* name;
+        qint64 windowStartNSecs;
+        qint64 totalNSecs;
+        int count;
+    };
+
+    struct ThreadBuffer
+    {
+        QMutex mutex;
+        // Grows up to RingSize, then the oldest scopes are overwritten
+        std::vector<TraceScope> scopes;
+        // Scopes recorded since the recording started. Past RingSize, the ring wrapped.
+        quint64 recordedCount = 0;
+        std::vector<Sum> sums;
+        QString threadName;
+        bool isThreadFinished = false;
+    };
+
+    QMutex buffersMutex;
+    int threadNumber = 0;
+
+    std::vector<std::shared_ptr<ThreadBuffer>>& Buffers()
+    {
+        static std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        return buffers;
+    }
+
+    // The buffer mutex must be held by the callers of the functions below
+    void Append(ThreadBuffer& buffer, TraceScope scope)
+    {
+        if (buffer.scopes.size() < static_cast<size_t>(Trace::RingSize))
+            buffer.scopes.push_back(std::move(scope));
+        else
+            buffer.scopes[buffer.recordedCount % Trace::RingSize] = std::move(scope);
+        buffer.recordedCount++;
+    }
+
+    void RecordSum(ThreadBuffer& buffer, const Sum& sum)
+    {
+        Append(buffer, {sum.name, sum.windowStartNSecs, sum.windowStartNSecs + sum.totalNSecs,
+                        QString("%1 calls").arg(sum.count)});
+    }
+
+    void RecordSums(ThreadBuffer& buffer)
+    {
+        for (const Sum& sum : buffer.sums)
+        {
+            RecordSum(buffer, sum);
+        }
+        buffer.sums.clear();
+    }
+
+    // Keeps only the recorded scopes, oldest first, and frees the rest of the ring
+    void Compact(ThreadBuffer& buffer)
+    {
+        RecordSums(buffer);
+        if (buffer.recordedCount > buffer.scopes.size())
+        {
+            auto oldest = buffer.scopes.begin() + buffer.recordedCount % Trace::RingSize;
+            std::rotate(buffer.scopes.begin(), oldest, buffer.scopes.end());
+        }
+        buffer.recordedCount = buffer.scopes.size();
+        buffer.scopes.shrink_to_fit();
+        buffer.sums.shrink_to_fit();
+    }
+
+    void Release(const std::shared_ptr<ThreadBuffer>& buffer)
+    {
+        bool isEmpty;
+        {
+            QMutexLocker locker(&buffer->mutex);
+            Compact(*buffer);
+            buffer->isThreadFinished = true;
+            isEmpty = buffer->scopes.empty();
+        }
+        if (isEmpty)
+        {
+            QMutexLocker locker(&buffersMutex);
+            auto& buffers = Buffers();
+            buffers.erase(std::remove(buffers.begin(), buffers.end(), buffer), buffers.end());
+        }
+    }
+
+    // Compacts the buffer when its thread finishes, as pool threads expire and are replaced.
+    // The scopes stay for Save until the next recording starts.
+    struct BufferOwner
+    {
+        std::shared_ptr<ThreadBuffer> buffer;
+
+        ~BufferOwner()
+        {
+            if (buffer)
+                Release(buffer);
+        }
+    };
+
+    // The buffer of the calling thread, made when it records its first scope
+    ThreadBuffer& CurrentBuffer()
+    {
+        thread_local BufferOwner owner;
+        if (!owner.buffer)
+        {
+            owner.buffer = std::make_shared<ThreadBuffer>();
+            QThread* thread = QThread::currentThread();
+            bool isMainThread = QCoreApplication::instance() && thread == QCoreApplication::instance()->thread();
+            QMutexLocker locker(&buffersMutex);
+            QString name = thread->objectName().isEmpty() ? QString("Thread") : thread->objectName();
+            owner.buffer->threadName = isMainThread ? QString("Main") : QString("%1 %2").arg(name).arg(++threadNumber);
+            Buffers().push_back(owner.buffer);
+        }
+        return *owner.buffer;
+    }
+}
+
+namespace Trace
+{
+    std::atomic<bool> isRecording{false};
+
+    void SetRecording(bool recording)
+    {
+        // Scopes that end after the recording stopped are dropped, as their buffer was compacted
+        isRecording.store(recording, std::memory_order_relaxed);
+
+        QMutexLocker locker(&buffersMutex);
+        auto& buffers = Buffers();
+        if (recording)
+        {
+            buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                         [](const std::shared_ptr<ThreadBuffer>& buffer) {
+                                             QMutexLocker bufferLocker(&buffer->mutex);
+                                             return buffer->isThreadFinished;
+                                         }),
+                          buffers.end());
+        }
+        for (const auto& buffer : buffers)
+        {
+            QMutexLocker bufferLocker(&buffer->mutex);
+            if (recording)
+            {
+                buffer->scopes = std::vector<TraceScope>();
+                buffer->sums.clear();
+                buffer->recordedCount = 0;
+            }
+            else
+            {
+                Compact(*buffer);
+            }
+        }
+    }
+
+    int ScopeCount()
+    {
+        quint64 count = 0;
+        QMutexLocker locker(&buffersMutex);
+        for (const auto& buffer : Buffers())
+        {
+            QMutexLocker bufferLocker(&buffer->mutex);
+            count += std::min<quint64>(buffer->recordedCount, RingSize) + buffer->sums.size();
+        }
+        return static_cast<int>(std::min<quint64>(count, std::numeric_limits<int>::max()));
+    }
+
+    void Record(const char* name, qint64 startNSecs, const QString& detail)
+    {
+        const qint64 endNSecs = NowNSecs();
+        ThreadBuffer& buffer = CurrentBuffer();
+        QMutexLocker locker(&buffer.mutex);
+        if (IsRecording())
+            Append(buffer, {name, startNSecs, endNSecs, detail});
+    }
+
+    void AddToSum(const char* name, qint64 startNSecs)
+    {
+        const qint64 endNSecs = NowNSecs();
+        ThreadBuffer& buffer = CurrentBuffer();
+        QMutexLocker locker(&buffer.mutex);
+        if (!IsRecording())
+            return;
+
+        auto sum = std::find_if(buffer.sums.begin(), buffer.sums.end(),
+                                [name](const Sum& candidate) { return candidate.name == name; });
+        if (sum == buffer.sums.end())
+        {
+            buffer.sums.push_back({name, startNSecs, 0, 0});
+            sum = buffer.sums.end() - 1;
+        }
+        sum->totalNSecs += endNSecs - startNSecs;
+        sum->count++;
+        if (endNSecs - sum->windowStartNSecs >= SumWindowNSecs)
+        {
+            RecordSum(buffer, *sum);
+            buffer.sums.erase(sum);
+        }
+    }
+
+    bool Save(const QString& path, QString& error)
+    {
+        const qint64 pid = QCoreApplication::applicationPid();
+        QJsonArray traceEvents;
+        qint64 originNSecs = std::numeric_limits<qint64>::max();
+        std::vector<std::pair<int, TraceScope>> scopes;
+        {
+            QMutexLocker locker(&buffersMutex);
+            const auto& buffers = Buffers();
+            for (int tid = 0; tid < static_cast<int>(buffers.size()); tid++)
+            {
+                ThreadBuffer& buffer = *buffers[tid];
+                QMutexLocker bufferLocker(&buffer.mutex);
+                RecordSums(buffer);
+                if (buffer.recordedCount == 0)
+                    continue;
+
+                traceEvents.append(QJsonObject{
+                    {"name", "thread_name"},
+                    {"ph", "M"},
+                    {"pid", pid},
+                    {"tid", tid},
+                    {"args", QJsonObject{{"name", buffer.threadName}}},
+                });
+
+                const quint64 count = std::min<quint64>(buffer.recordedCount, RingSize);
+                for (quint64 i = buffer.recordedCount - count; i < buffer.recordedCount; i++)
+                {
+                    const TraceScope& scope = buffer.scopes[i % RingSize];
+                    originNSecs = std::min(originNSecs, scope.startNSecs);
+                    scopes.emplace_back(tid, scope);
+                }
+            }
+        }
+
+        // Chrome wants microseconds, and a trace that starts near zero is easier to read
+        for (const auto& tidScope : scopes)
+        {
+            const TraceScope& scope = tidScope.second;
+            QJsonObject traceEvent{
+                {"name", scope.name},
+                {"cat", "tlv"},
+                {"ph", "X"},
+                {"ts", (scope.startNSecs - originNSecs) / 1000.0},
+                {"dur", (scope.endNSecs - scope.startNSecs) / 1000.0},
+                {"pid", pid},
+                {"tid", tidScope.first},
+            };
+            if (!scope.detail.isEmpty())
+                traceEvent["args"] = QJsonObject{{"detail", scope.detail}};
+            traceEvents.append(traceEvent);
+        }
+
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            error = file.errorString();
+            return false;
+        }
+        QJsonObject trace{
+            {"traceEvents", traceEvents},
+            {"displayTimeUnit", "ms"},
+        };
+        if (file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact)) < 0)
+        {
+            error = file.errorString();
+            return false;
+        }
+        return true;
+    }
+}
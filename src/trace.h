@@ -0,0 +1,104 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <QString>
+
+// Timing of the phases of loading, filtering and showing events, to find where the time goes on a
+// machine we cannot debug. While recording, scopes go into a ring buffer per thread, which grows up
+// to RingSize as scopes are recorded. When the recording stops or a thread finishes, only its
+// recorded scopes are kept. They are saved as Chrome trace event JSON, which chrome://tracing and
+// ui.perfetto.dev open.
+// When not recording, a scope costs one relaxed atomic load.
+namespace Trace
+{
+    // Scopes kept per thread. The oldest ones are overwritten.
+    const int RingSize = 1 << 16;
+    // Summed scopes of a name are recorded once per window
+    const qint64 SumWindowNSecs = 10 * 1000 * 1000;
+
+    extern std::atomic<bool> isRecording;
+
+    inline bool IsRecording()
+    {
+        return isRecording.load(std::memory_order_relaxed);
+    }
+
+    inline qint64 NowNSecs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Starting a recording forgets the scopes of the one before. Stopping it keeps the scopes for Save.
+    void SetRecording(bool recording);
+    int ScopeCount();
+    // Writes the recorded scopes of all threads. On failure, error says why.
+    bool Save(const QString& path, QString& error);
+
+    void Record(const char* name, qint64 startNSecs, const QString& detail);
+    void AddToSum(const char* name, qint64 startNSecs);
+
+    // Records the time between its construction and its destruction. The name must outlive the
+    // recording, like a string literal.
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name) :
+            m_name(IsRecording() ? name : nullptr),
+            m_startNSecs(m_name ? NowNSecs() : 0)
+        {
+        }
+
+        Scope(const char* name, const QString& detail) :
+            m_name(IsRecording() ? name : nullptr),
+            m_startNSecs(m_name ? NowNSecs() : 0)
+        {
+            if (m_name)
+                m_detail = detail;
+        }
+
+        ~Scope()
+        {
+            if (m_name)
+                Record(m_name, m_startNSecs, m_detail);
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* m_name;
+        qint64 m_startNSecs;
+        QString m_detail;
+    };
+
+    // Like Scope, for steps that run for every line or value. Their times are summed per thread and
+    // name, and recorded as one scope per SumWindowNSecs with the number of calls, so they do not
+    // fill the ring. The recorded scope starts with the window and lasts the summed time.
+    class SummedScope
+    {
+    public:
+        explicit SummedScope(const char* name) :
+            m_name(IsRecording() ? name : nullptr),
+            m_startNSecs(m_name ? NowNSecs() : 0)
+        {
+        }
+
+        ~SummedScope()
+        {
+            if (m_name)
+                AddToSum(m_name, m_startNSecs);
+        }
+
+        SummedScope(const SummedScope&) = delete;
+        SummedScope& operator=(const SummedScope&) = delete;
+
+    private:
+        const char* m_name;
+        qint64 m_startNSecs;
+    };
+}
+
+#endif // TRACE_H
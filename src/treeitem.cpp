@@ -114,3 +114,20 @@ bool TreeItem::SetData(int column, const QVariant &value)
     m_itemData[column] = value;
     return true;
 }
+
+qint64 TreeItem::MemoryBytes() const
+{
+    qint64 bytes = sizeof(TreeItem) +
+                   m_childItems.capacity() * sizeof(TreeItem*) +
+                   m_itemData.capacity() * sizeof(QVariant);
+    for (const QVariant& data : m_itemData)
+    {
+        if (data.typeId() == QMetaType::QString)
+            bytes += data.toString().size() * sizeof(QChar);
+    }
+    for (const TreeItem* child : m_childItems)
+    {
+        bytes += child->MemoryBytes();
+    }
+    return bytes;
+}
@@ -23,6 +23,8 @@ public:
     bool RemoveColumns(int position, int columns);
     int ChildNumber() const;
     bool SetData(int column, const QVariant &value);
+    // Estimated bytes of this item and of the items under it
+    qint64 MemoryBytes() const;
 
 private:
     QList<TreeItem*> m_childItems;
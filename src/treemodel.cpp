@@ -1,31 +1,97 @@
 #include "treemodel.h"
 
 #include "options.h"
+#include "parallelutils.h"
 #include "qjsonutils.h"
 #include "themeutils.h"
+#include "timeutils.h"
+#include "trace.h"
 #include "treeitem.h"
-
+#include "vectorutils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <QJsonDocument>
 #include <QJsonObject>
 #include <QtWidgets>
 
+namespace
+{
+    // Entries of TreeModel::m_highlightIndexes that are not filter indexes
+    const qint16 NoHighlight = -1;
+    const qint16 HighlightNotEvaluated = -2;
+
+    // Entries sampled to estimate the size of the structures with one per row
+    const int MemorySampleSize = 256;
+
+    // Sums bytesAt over a sample of the count entries, and extrapolates it to all of them
+    qint64 SampledBytes(int count, const std::function<qint64(int)>& bytesAt)
+    {
+        const int step = std::max(1, count / MemorySampleSize);
+        qint64 sampleBytes = 0;
+        int sampleCount = 0;
+        for (int i = 0; i < count; i += step)
+        {
+            sampleBytes += bytesAt(i);
+            sampleCount++;
+        }
+        return (sampleCount > 0) ? sampleBytes * count / sampleCount : 0;
+    }
+}
 
 TreeModel::TreeModel(const QStringList &headers, const EventListPtr events, QObject *parent)
-    : QAbstractItemModel(parent)
+    : TreeModel(headers, events, std::vector<int>(), parent)
+{
+}
+
+/// <summary>
+/// Model of the given rows of events, which stays valid as long as the model lives. The list of
+/// events is shared rather than copied, and whichever model changes it first gets its own copy.
+/// </summary>
+TreeModel::TreeModel(const QStringList &headers, const EventListPtr events, std::vector<int> rows, QObject *parent)
+    : QAbstractItemModel(parent),
+      m_allEvents(events),
+      m_storeRows(std::move(rows))
+{
+    Init(headers);
+}
+
+/// <summary>
+/// Model of the given rows of the events of a paged log, all of them when there are no rows.
+/// The events are parsed as the rows are used.
+/// </summary>
+TreeModel::TreeModel(const QStringList &headers, const PagedEventsPtr events, std::vector<int> rows, QObject *parent)
+    : QAbstractItemModel(parent),
+      m_allEvents(std::make_shared<EventList>()),
+      m_storeRows(std::move(rows)),
+      m_pagedEvents(events)
+{
+    Init(headers);
+}
+
+void TreeModel::Init(const QStringList &headers)
 {
     QVector<QVariant> rootData;
     foreach (QString header, headers)
         rootData << header;
 
     m_rootItem = new TreeItem(rootData);
-    m_allEvents = events;
-    SetupModelData(m_rootItem);
+    m_hiddenRows.assign(EventCount(), false);
+    // A paged log keeps its events in the file, so it doesn't keep their search strings either
+    if (!m_pagedEvents)
+        m_valueSearchStrings.resize(EventCount());
 
     HighlightOptions defaultHighlightOpts = Options::GetInstance().getDefaultHighlightOpts();
     if (!defaultHighlightOpts.isEmpty())
     {
         m_highlightOpts = defaultHighlightOpts;
         m_colorLibrary.Exclude(m_highlightOpts.GetColors());
+        UpdateHighlightPalette();
     }
+    EvaluateHighlights();
 
     m_highlightOnlyMode = false;
     m_liveMode = false;
@@ -33,18 +99,44 @@ TreeModel::TreeModel(const QStringList &headers, const EventListPtr events, QObj
 
 TreeModel::~TreeModel()
 {
+    ClearDetailItems();
     delete m_rootItem;
 }
 
 int TreeModel::columnCount(const QModelIndex & /* parent */) const
 {
-    return m_rootItem->ColumnCount();
+    return m_rootItem->ColumnCount() + static_cast<int>(m_pathColumns.size());
 }
 
 QVariant TreeModel::data(const QModelIndex &index, int role) const
 {
     int col = index.column();
 
+    if (const PathColumn* pathColumn = GetPathColumn(col))
+    {
+        // Path columns only have values on the top-level rows
+        bool isTopLevel = IsTopLevel(index);
+        int row = StorageRow(index.row());
+        switch (role)
+        {
+            case Qt::UserRole:
+                return isTopLevel ? pathColumn->Data(row) : QVariant();
+            case Qt::DisplayRole:
+            case Qt::ToolTipRole:
+                return isTopLevel ? pathColumn->DisplayString(row) : QVariant();
+            case Qt::TextAlignmentRole:
+                if (isTopLevel && pathColumn->IsNumber(row))
+                    return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+                return QVariant();
+            case Qt::ForegroundRole:
+            case Qt::BackgroundRole:
+                // Highlight the row like the fixed columns do
+                break;
+            default:
+                return QVariant();
+        }
+    }
+
     switch (role)
     {
         case Qt::ForegroundRole:
@@ -53,69 +145,57 @@ QVariant TreeModel::data(const QModelIndex &index, int role) const
             {
                 return QColor(Qt::gray);
             }*/
-            QColor highlightColor(ItemHighlightColor(index));
-            if (highlightColor == Qt::transparent)
+            int highlightIndex = ItemHighlightIndex(index);
+            if (highlightIndex < 0)
             {
                 // do nothing if there's no highlight color
                 break;
             }
-            // Pick a White or Black foreground, depending on which one gives better contrast
-            double whiteContrast = ThemeUtils::ContrastRatio(QColor(Qt::white), highlightColor);
-            double blackContrast = ThemeUtils::ContrastRatio(QColor(Qt::black), highlightColor);
-            return whiteContrast > blackContrast ? QColor(Qt::white) : QColor(Qt::black);
+            return m_highlightPalette[highlightIndex].foreground;
         }
         case Qt::BackgroundRole:
         {
-            QColor highlightColor(ItemHighlightColor(index));
-            if (highlightColor != Qt::transparent)
+            int highlightIndex = ItemHighlightIndex(index);
+            if (highlightIndex >= 0)
             {
-                return QBrush(highlightColor);
+                return m_highlightPalette[highlightIndex].background;
             }
             break;
         }
         case Qt::UserRole:
         {
-            TreeItem* item = GetItem(index);
-            return item->Data(col);
+            return CellData(index);
         }
         case Qt::DisplayRole:
         {
-            TreeItem* item = GetItem(index);
+            QVariant cell = CellData(index);
             if (col == COL::Time)
             {
-                QDateTime dateTime = item->Data(col).toDateTime();
-                if (!dateTime.isValid())
+                QVariant usecs = cell;
+                if (!usecs.isValid())
                     return "";
 
-                switch (m_timeMode)
-                {
-                   case TimeMode::GlobalDateTime:
-                      return dateTime.toString("MM/dd/yyyy - hh:mm:ss.zzz");
-                   case TimeMode::GlobalTime:
-                      return dateTime.toString("hh:mm:ss.zzz");
-                   case TimeMode::TimeDeltas:
-                      return GetDeltaMSecs(dateTime);
-                }
+                return GetTimeDisplayString(usecs.toLongLong());
             }
             else if (col == COL::ART)
             {
                 // Display a black circle if ART data is present
                 // 0xE2978F = BLACK CIRCLE
                 QString blackCircle = QString::fromUtf8("\xE2\x97\x8F");
-                return (item->Data(col).toString().isEmpty()) ? "" : blackCircle;
+                return (cell.toString().isEmpty()) ? "" : blackCircle;
             }
             else if (col == COL::ErrorCode)
             {
                 // Display a black square if an error code is present
                 // 0xE296A0 = BLACK SQUARE
                 QString blackSquare = QString::fromUtf8("\xE2\x96\xA0");
-                return (item->Data(col).toString().isEmpty()) ? "" : blackSquare;
+                return (cell.toString().isEmpty()) ? "" : blackSquare;
             }
-            if (item->Data(col).typeId() == QMetaType::Double	)
+            if (cell.typeId() == QMetaType::Double	)
             {
-                return QString::number(item->Data(col).toDouble(), 'f', 3);
+                return QString::number(cell.toDouble(), 'f', 3);
             }
-            return item->Data(col);
+            return cell;
         }
         case Qt::ToolTipRole:
         {
@@ -132,10 +212,18 @@ QVariant TreeModel::data(const QModelIndex &index, int role) const
                 }
                 return tip;
             }
+            else if (col == COL::Time)
+            {
+                // The cell holds microseconds since the epoch, so show the full date and time instead
+                QVariant usecs = CellData(index);
+                if (!usecs.isValid())
+                    return QVariant();
+
+                return TimeUtils::FormatDateTime(usecs.toLongLong());
+            }
             else
             {
-                TreeItem* item = GetItem(index);
-                return item->Data(col);
+                return CellData(index);
             }
             break;
         }
@@ -163,6 +251,9 @@ Qt::ItemFlags TreeModel::flags(const QModelIndex &index) const
     return Qt::ItemIsEditable | QAbstractItemModel::flags(index);
 }
 
+/// <summary>
+/// Item of a detail row, or the root for the invalid index. Top-level rows have no item.
+/// </summary>
 TreeItem *TreeModel::GetItem(const QModelIndex &index) const
 {
     if (index.isValid())
@@ -193,7 +284,11 @@ QVariant TreeModel::headerData(int section, Qt::Orientation orientation,
                                int role) const
 {
     if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
+    {
+        if (const PathColumn* pathColumn = GetPathColumn(section))
+            return pathColumn->Path();
         return m_rootItem->Data(section);
+    }
 
     return QVariant();
 }
@@ -203,8 +298,15 @@ QModelIndex TreeModel::index(int row, int column, const QModelIndex &parent) con
     if (parent.isValid() && parent.column() != 0)
         return QModelIndex();
 
-    TreeItem *parentItem = GetItem(parent);
+    // Top-level rows have no item, their cells come from the events
+    if (!parent.isValid())
+    {
+        if (row < 0 || row >= EventCount() || column < 0 || column >= columnCount())
+            return QModelIndex();
+        return createIndex(row, column, nullptr);
+    }
 
+    TreeItem *parentItem = IsTopLevel(parent) ? DetailsItem(StorageRow(parent.row())) : GetItem(parent);
     TreeItem *childItem = parentItem->Child(row);
     if (childItem)
         return createIndex(row, column, childItem);
@@ -225,7 +327,11 @@ bool TreeModel::insertColumns(int position, int columns, const QModelIndex &pare
 
 bool TreeModel::insertRows(int position, int rows, const QModelIndex &parent)
 {
-    TreeItem *parentItem = GetItem(parent);
+    // Top-level rows are only added with their events, by MergeIntoModelData and AddToModelData
+    if (!parent.isValid())
+        return false;
+
+    TreeItem *parentItem = IsTopLevel(parent) ? DetailsItem(StorageRow(parent.row())) : GetItem(parent);
     bool success;
 
     beginInsertRows(parent, position, position + rows - 1);
@@ -237,14 +343,15 @@ bool TreeModel::insertRows(int position, int rows, const QModelIndex &parent)
 
 QModelIndex TreeModel::parent(const QModelIndex &index) const
 {
-    if (!index.isValid())
+    if (!index.isValid() || IsTopLevel(index))
         return QModelIndex();
 
     TreeItem *childItem = GetItem(index);
     TreeItem *parentItem = childItem->Parent();
 
-    if (parentItem == m_rootItem)
-        return QModelIndex();
+    // The item holding the details of a top-level row keeps that row
+    if (parentItem->Parent() == m_rootItem)
+        return createIndex(ViewRow(parentItem->Data(0).toInt()), 0, nullptr);
 
     return createIndex(parentItem->ChildNumber(), 0, parentItem);
 }
@@ -265,21 +372,28 @@ bool TreeModel::removeColumns(int position, int columns, const QModelIndex &pare
 
 bool TreeModel::removeRows(int position, int count, const QModelIndex &parent)
 {
-    TreeItem *parentItem = GetItem(parent);
+    const bool isTopLevel = !parent.isValid();
     bool success = true;
     int originalCount = rowCount(parent);
+    if (isTopLevel && (position < 0 || count < 0 || position + count > originalCount))
+        return false;
+
+    // Rows are removed in their original order, e.g. the oldest ones when trimming a live capture
+    if (isTopLevel)
+        SetSortOrder(std::vector<int>());
+
     int endPosition = position + count - 1;
 
-    for (int i = position; i <= endPosition; i++)
+    beginRemoveRows(parent, position, endPosition);
+    if (!isTopLevel)
     {
-        m_highlightColorCache.remove(parentItem->Child(i));
+        TreeItem *parentItem = IsTopLevel(parent) ? DetailsItem(StorageRow(parent.row())) : GetItem(parent);
+        success = parentItem->RemoveChildren(position, count);
     }
-
-    beginRemoveRows(parent, position, endPosition);
-    success = parentItem->RemoveChildren(position, count);
     endRemoveRows();
 
-    if (success)
+    // Only top-level rows are backed by an event
+    if (success && isTopLevel)
     {
         if (count == originalCount)
         {
@@ -287,10 +401,9 @@ bool TreeModel::removeRows(int position, int count, const QModelIndex &parent)
         }
         else
         {
-            for (int i = position; i <= endPosition; i++)
-            {
-                m_allEvents->removeAt(i);
-            }
+            DetachEvents();
+            m_allEvents->erase(m_allEvents->begin() + position, m_allEvents->begin() + position + count);
+            RemoveRowState(position, count);
         }
     }
 
@@ -299,14 +412,41 @@ bool TreeModel::removeRows(int position, int count, const QModelIndex &parent)
 
 int TreeModel::rowCount(const QModelIndex &parent) const
 {
-    TreeItem *parentItem = GetItem(parent);
+    if (parent.isValid() && parent.column() != 0)
+        return 0;
+
+    if (!parent.isValid())
+        return EventCount();
+    if (IsTopLevel(parent))
+        return DetailsItem(StorageRow(parent.row()))->ChildCount();
+    return GetItem(parent)->ChildCount();
+}
+
+bool TreeModel::hasChildren(const QModelIndex &parent) const
+{
+    if (parent.isValid() && parent.column() != 0)
+        return false;
 
-    return parentItem->ChildCount();
+    if (!parent.isValid())
+        return EventCount() > 0;
+
+    // Answer for top-level rows from the event, so drawing the expand arrows doesn't build their details
+    if (IsTopLevel(parent))
+    {
+        auto details = m_detailItems.find(StorageRow(parent.row()));
+        if (details != m_detailItems.end())
+            return details->second->ChildCount() > 0;
+        QJsonValue value = ConsolidateValueAndActivity(Event(StorageRow(parent.row())));
+        return value.isObject() && !value.toObject().isEmpty();
+    }
+
+    return GetItem(parent)->ChildCount() > 0;
 }
 
 bool TreeModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    if (role != Qt::EditRole)
+    // The cells of top-level rows come from the events, which are never edited
+    if (role != Qt::EditRole || !index.isValid() || IsTopLevel(index))
         return false;
 
     TreeItem *item = GetItem(index);
@@ -346,7 +486,7 @@ QJsonObject TreeModel::GetEvent(QModelIndex idx) const
     }
     else
     {
-        return m_allEvents->at(idx.row());
+        return Event(StorageRow(row));
     }
 }
 
@@ -362,6 +502,74 @@ QString TreeModel::GetValueFullString(const QModelIndex& idx, bool singleLineFor
     return JsonToString(GetConsolidatedEventContent(idx), singleLineFormat);
 }
 
+/// <summary>
+/// Returns the text that find and highlight match the value column against.
+/// By default this is the single line value in the selected notation. With the raw search option it is
+/// the compact JSON of the value, which does not depend on the notation and is only built once per event.
+/// </summary>
+QString TreeModel::GetValueSearchString(const QModelIndex& idx) const
+{
+    QModelIndex topIdx = idx;
+    while (topIdx.parent().isValid())
+    {
+        topIdx = topIdx.parent();
+    }
+
+    int row = StorageRow(topIdx.row());
+    if (row < 0 || row >= EventCount())
+        return QString();
+
+    return ValueSearchString(row);
+}
+
+/// <summary>
+/// GetValueSearchString of a top-level row in the original order. Only touches the entry of that row,
+/// so different rows can be evaluated from different threads. Paged logs build the string every time,
+/// as caching it for every row would keep the whole file in memory.
+/// </summary>
+QString TreeModel::ValueSearchString(int row) const
+{
+    if (!Options::GetInstance().getSearchRawValue())
+        return JsonToString(ConsolidateValueAndActivity(Event(row)), true);
+
+    if (m_pagedEvents)
+        return RawValueSearchString(row);
+
+    QString& searchStr = m_valueSearchStrings[row];
+    if (searchStr.isNull())
+    {
+        searchStr = RawValueSearchString(row);
+    }
+    return searchStr;
+}
+
+QString TreeModel::RawValueSearchString(int row) const
+{
+    QString searchStr;
+    QJsonValue value = ConsolidateValueAndActivity(Event(row));
+    if (value.isObject())
+        searchStr = QString::fromUtf8(QJsonDocument(value.toObject()).toJson(QJsonDocument::Compact));
+    else if (value.isArray())
+        searchStr = QString::fromUtf8(QJsonDocument(value.toArray()).toJson(QJsonDocument::Compact));
+    else if (value.isString())
+        searchStr = value.toString();
+    else
+        searchStr = value.toVariant().toString();
+
+    // Keep built entries apart from the null "not built" marker
+    if (searchStr.isNull())
+        searchStr = "";
+    return searchStr;
+}
+
+void TreeModel::ClearSearchCache()
+{
+    m_valueSearchStrings.assign(m_valueSearchStrings.size(), QString());
+    // The options change how the value and the activity data are shown
+    m_rowCells.clear();
+    EvaluateHighlights();
+}
+
 TABTYPE TreeModel::TabType() const
 {
     return m_fileType;
@@ -372,14 +580,17 @@ void TreeModel::SetTabType(TABTYPE type)
     m_fileType = type;
 }
 
-static QDateTime parseTs(QString value) {
-    QString microsecondFormat = "yyyy-MM-ddTHH:mm:ss.zzzzzz";
-    QString millisecondFormat = "yyyy-MM-ddTHH:mm:ss.zzz";
-    if (value.size() == microsecondFormat.size()) {
-       // Hyper prints higher precision times that QT can't parse, so truncating here
-       value = value.left(millisecondFormat.size());
-    }
-    return QDateTime::fromString(value, millisecondFormat);
+// Microseconds since the epoch of the event, or an invalid variant when there is no readable timestamp
+static QVariant parseTs(const QJsonObject& event) {
+    qint64 usecs;
+    if (TimeUtils::ParseTimestamp(event["ts"].toString(), usecs))
+        return usecs;
+    return QVariant();
+}
+
+// Events without a timestamp come first, like invalid QDateTimes used to
+static qint64 timeKey(const QVariant& usecs) {
+    return usecs.isValid() ? usecs.toLongLong() : std::numeric_limits<qint64>::min();
 }
 
 /// <summary>
@@ -390,147 +601,228 @@ static QDateTime parseTs(QString value) {
 /// </summary>
 int TreeModel::MergeIntoModelData(const EventList& events)
 {
-    int origIter = m_rootItem->ChildCount() - 1;
+    Trace::Scope scope("MergeIntoModelData");
+    // New events go to their place in the original order
+    SetSortOrder(std::vector<int>());
+
+    const int origCount = EventCount();
     if (events[0]["ts"].toString().isEmpty())
     {
         AddToModelData(events);
-        return origIter;
+        return origCount - 1;
     }
 
-    for (int mergeIter = events.size() - 1; mergeIter >= 0; mergeIter--)
+    // Rows of the new events once merged. Each goes after the original rows up to origIter and
+    // after the new events before it. All of them are inserted at once, as inserting them one by
+    // one shifts every row after them each time.
+    const int count = static_cast<int>(events.size());
+    std::vector<int> rows(count);
+    int origIter = origCount - 1;
+    for (int mergeIter = count - 1; mergeIter >= 0; mergeIter--)
     {
-        QDateTime mergeTime = parseTs(events[mergeIter]["ts"].toString());
-        for (; origIter >= 0; origIter--)
+        qint64 mergeTime = timeKey(parseTs(events[mergeIter]));
+        while (origIter >= 0 && mergeTime < timeKey(TopLevelData(origIter, COL::Time)))
         {
-            QDateTime origTime = m_rootItem->Child(origIter)->Data(COL::Time).toDateTime();
-            if (mergeTime >= origTime)
-            {
-                InsertChild(origIter + 1, events[mergeIter]);
-                break;
-            }
-        }
-
-        if (origIter < 0)
-        {
-            origIter = 0;
-            while (mergeIter >= 0)
-            {
-                InsertChild(0, events[mergeIter--]);
-            }
-            break;
+            origIter--;
         }
+        rows[mergeIter] = origIter + 1 + mergeIter;
+    }
+    InsertEvents(events, rows);
+    {
+        Trace::Scope signalScope("layoutChanged");
+        layoutChanged();
     }
-    layoutChanged();
 
-    return origIter;
+    return std::max(origIter, 0);
 }
 
 void TreeModel::AddToModelData(const EventList& events)
 {
-    for (const auto& event : events)
-    {
-        InsertChild(m_rootItem->ChildCount(), event);
-    }
+    SetSortOrder(std::vector<int>());
+    std::vector<int> rows(events.size());
+    std::iota(rows.begin(), rows.end(), EventCount());
+    InsertEvents(events, rows);
+    Trace::Scope scope("layoutChanged");
     layoutChanged();
 }
 
-void TreeModel::InsertChild(int position, const QJsonObject & event)
+/// <summary>
+/// Insert events at top-level rows, which are sorted and counted after the insertion. The events,
+/// the tree items and each piece of per-row state are spread once for the whole batch.
+/// </summary>
+void TreeModel::InsertEvents(const EventList& events, const std::vector<int>& rows)
 {
-    m_allEvents->insert(position, event);
-    m_rootItem->InsertChildren(position, 1, m_rootItem->ColumnCount());
-    auto child = m_rootItem->Child(position);
-    if (!child)
-    {
-        qCritical() << "Cannot get item at" << position;
+    if (rows.empty())
         return;
+
+    DetachEvents();
+    const int origCount = EventCount();
+    VectorUtils::InsertAtRows(*m_allEvents, rows, [&events](int i) { return events[i]; });
+    VectorUtils::InsertAtRows(m_hiddenRows, rows, [](int) { return false; });
+    if (!m_pagedEvents)
+        VectorUtils::InsertAtRows(m_valueSearchStrings, rows, [](int) { return QString(); });
+    VectorUtils::InsertAtRows(m_highlightIndexes, rows, [](int) { return HighlightNotEvaluated; });
+    for (auto& pathColumn : m_pathColumns)
+    {
+        pathColumn.InsertRows(rows, [this](int row) { return Event(row); });
     }
 
-    SetupChild(child, event);
+    if (rows.front() != origCount)
+    {
+        // Cached cells are keyed by row, which moves for every row after an inserted one
+        m_rowCells.clear();
+
+        // An original row moves down by the number of new rows that go before it
+        std::vector<int> origPositions(rows.size());
+        for (size_t i = 0; i < rows.size(); i++)
+        {
+            origPositions[i] = rows[i] - static_cast<int>(i);
+        }
+        auto newRow = [&origPositions](int row) {
+            return row + static_cast<int>(std::upper_bound(origPositions.begin(), origPositions.end(), row) -
+                                          origPositions.begin());
+        };
+        for (auto& hiddenRows : m_hideUndoStack)
+        {
+            for (int& row : hiddenRows)
+            {
+                row = newRow(row);
+            }
+        }
+
+        std::map<int, TreeItem*> detailItems;
+        for (const auto& rowItem : m_detailItems)
+        {
+            const int row = newRow(rowItem.first);
+            rowItem.second->SetData(0, row);
+            detailItems.emplace_hint(detailItems.end(), row, rowItem.second);
+        }
+        m_detailItems.swap(detailItems);
+    }
+
+    UpdateColumnIndexes(rows);
 }
 
-void SetValueDisplayString(TreeItem* child, QString str)
+static QString ValueDisplayString(QString str)
 {
     // Limit string size in the tree view to prevent UI stutters.
     const int MaxDisplayStringSize = 300;
 
     str.truncate(MaxDisplayStringSize);
     str.replace("\n", " ");
-    child->SetData(COL::Value, str);
+    return str;
 }
 
-void TreeModel::SetupChild(TreeItem *child, const QJsonObject & event)
+static void SetValueDisplayString(TreeItem* child, const QString& str)
 {
-    child->SetData(COL::ID, event["idx"].toInt());
-    child->SetData(COL::File, event["file"].toString());
-    child->SetData(COL::Time, parseTs(event["ts"].toString()));
-    child->SetData(COL::PID, event["pid"].toInt());
-    child->SetData(COL::TID, event["tid"].toString());
-    child->SetData(COL::Severity, event["sev"].toString());
-    child->SetData(COL::Request, event["req"].toString());
-    child->SetData(COL::Session, event["sess"].toString());
-    child->SetData(COL::Site, event["site"].toString());
-    child->SetData(COL::User, event["user"].toString());
-    child->SetData(COL::Key, event["k"].toString());
-    bool hasArtData = event.contains("a");
-    bool hasErrorCode = event.contains("e");
-    if (hasArtData)
+    child->SetData(COL::Value, ValueDisplayString(str));
+}
+
+/// <summary>
+/// Cell of a top-level row, in the original order, computed from its event.
+/// Only reads the event, so it can be called from worker threads.
+/// </summary>
+QVariant TreeModel::TopLevelData(int row, int column) const
+{
+    const QJsonObject& event = Event(row);
+    switch (column)
     {
-        child->SetData(COL::ART, JsonToString(event["a"], false));
+        case COL::ID:
+            return event["idx"].toInt();
+        case COL::File:
+            return event["file"].toString();
+        case COL::Time:
+            return parseTs(event);
+        case COL::Elapsed:
+            // Filled in by ProcessEvent while parsing
+            return event.contains("elapsed") ? event["elapsed"].toDouble() : QVariant();
+        case COL::PID:
+            return event["pid"].toInt();
+        case COL::TID:
+            return event["tid"].toString();
+        case COL::Severity:
+            return event["sev"].toString();
+        case COL::Request:
+            return event["req"].toString();
+        case COL::Session:
+            return event["sess"].toString();
+        case COL::Site:
+            return event["site"].toString();
+        case COL::User:
+            return event["user"].toString();
+        case COL::Key:
+            return event["k"].toString();
+        case COL::ART:
+            return event.contains("a") ? JsonToString(event["a"], false) : QVariant();
+        case COL::ErrorCode:
+            return event.contains("e") ? JsonToString(event["e"], false) : QVariant();
+        case COL::Value:
+            return ValueDisplayString(JsonToString(ConsolidateValueAndActivity(event)));
     }
-    if (hasErrorCode)
+    return QVariant();
+}
+
+/// <summary>
+/// Cell of idx. Nested rows keep their cells in the tree items. Top-level rows are computed from the
+/// events, and the cells of the rows recently on screen are kept in m_rowCells.
+/// </summary>
+QVariant TreeModel::CellData(const QModelIndex& idx) const
+{
+    if (!IsTopLevel(idx))
+        return GetItem(idx)->Data(idx.column());
+
+    int row = StorageRow(idx.row());
+    QVector<QVariant>* cells = m_rowCells.object(row);
+    if (!cells)
     {
-        child->SetData(COL::ErrorCode, JsonToString(event["e"], false));
+        cells = new QVector<QVariant>(m_rootItem->ColumnCount());
+        for (int column = 0; column < cells->size(); column++)
+        {
+            (*cells)[column] = TopLevelData(row, column);
+        }
+        m_rowCells.insert(row, cells);
     }
+    return cells->value(idx.column());
+}
+
+bool TreeModel::IsTopLevel(const QModelIndex& idx) const
+{
+    return idx.isValid() && idx.internalPointer() == nullptr;
+}
 
-    QJsonValue v = ConsolidateValueAndActivity(event);
-    SetValueDisplayString(child, JsonToString(v));
+/// <summary>
+/// Item holding the nested rows of the top-level row, in the original order. It is created the
+/// first time the row is expanded, so a log only pays for the items of the rows that were opened.
+/// </summary>
+TreeItem* TreeModel::DetailsItem(int row) const
+{
+    auto details = m_detailItems.find(row);
+    if (details != m_detailItems.end())
+        return details->second;
+
+    Trace::Scope scope("BuildDetails");
+    // Its only data is the row, which parent() reads. It is not a child of the root.
+    TreeItem* item = new TreeItem(QVector<QVariant>{row}, m_rootItem);
+    m_detailItems.emplace(row, item);
+    QJsonValue v = ConsolidateValueAndActivity(Event(row));
     if (v.isObject())
     {
         QJsonObject obj = v.toObject();
-        AddChildren(obj, child);
-    }
-
-    // calculate "Elapsed"
-    if (child->Parent() == m_rootItem)
-    {
-        if (hasArtData)
-        {
-            QJsonObject artObject = event["a"].toObject();
-            if (artObject.contains("elapsed"))
-            {
-                child->SetData(COL::Elapsed, artObject["elapsed"].toDouble());
-                return;
-            }
-        }
-        for (int i = 0; i < child->ChildCount(); i++)
-        {
-            auto c = child->Child(i);
-            if (c->Data(COL::Key) == "elapsed" || c->Data(COL::Key) == "created-elapsed")
-            {
-                auto val = c->Data(COL::Value);
-                child->SetData(COL::Elapsed, val.toDouble());
-                return;
-            }
-            else if (c->Data(COL::Key) == "elapsedMs" || c->Data(COL::Key) == "elapsed-ms")
-            {
-                auto val = c->Data(COL::Value);
-                child->SetData(COL::Elapsed, val.toDouble() / 1000);
-                return;
-            }
-        }
+        AddChildren(obj, item);
     }
+    return item;
 }
 
-void TreeModel::SetupModelData(TreeItem *parent)
+void TreeModel::ClearDetailItems()
 {
-    for (const auto& event : *m_allEvents)
+    for (const auto& rowItem : m_detailItems)
     {
-        TreeItem* child = parent->AddChild();
-        SetupChild(child, event);
+        delete rowItem.second;
     }
+    m_detailItems.clear();
 }
 
-void TreeModel::AddChildren(QJsonObject &obj, TreeItem *parent)
+void TreeModel::AddChildren(QJsonObject &obj, TreeItem *parent) const
 {
     for (QJsonObject::ConstIterator iter = obj.constBegin(); iter != obj.constEnd(); ++iter)
     {
@@ -538,9 +830,11 @@ void TreeModel::AddChildren(QJsonObject &obj, TreeItem *parent)
     }
 }
 
-void TreeModel::AddChild(const QString& key, const QJsonValue& value, TreeItem* parent)
+void TreeModel::AddChild(const QString& key, const QJsonValue& value, TreeItem* parent) const
 {
-    TreeItem* child = parent->AddChild();
+    // Items holding details only keep their row, so size the children like the root
+    parent->InsertChildren(parent->ChildCount(), 1, m_rootItem->ColumnCount());
+    TreeItem* child = parent->Child(parent->ChildCount() - 1);
     child->SetData(COL::Key, key);
 
     if (value.isDouble())
@@ -579,22 +873,33 @@ void TreeModel::AddChild(const QString& key, const QJsonValue& value, TreeItem*
     }
 }
 
-QColor TreeModel::ItemHighlightColor(const QModelIndex& idx) const
+/// <summary>
+/// Index of the highlight filter that colors the row of idx, or -1 when no filter matches.
+/// </summary>
+int TreeModel::ItemHighlightIndex(const QModelIndex& idx) const
 {
-    TreeItem* item = GetItem(idx);
-    if (item == nullptr || item->Parent() != m_rootItem)
-        return Qt::transparent;
+    if (!IsTopLevel(idx))
+        return NoHighlight;
 
-    auto cachedColor = m_highlightColorCache.find(item);
-    if (cachedColor != m_highlightColorCache.end())
-        return cachedColor.value();
+    qint16& highlightIndex = m_highlightIndexes[StorageRow(idx.row())];
+    if (highlightIndex == HighlightNotEvaluated)
+    {
+        highlightIndex = EvaluateHighlight(StorageRow(idx.row()), 0);
+    }
+    return highlightIndex;
+}
 
+/// <summary>
+/// Test a top-level row, in the original order, against the highlight filters from firstFilter on.
+/// Iterate in reverse so the rightmost filter that matches wins.
+/// </summary>
+qint16 TreeModel::EvaluateHighlight(int row, int firstFilter) const
+{
     QString valueStr;
 
-    // iterate in reverse so the rightmost tab that matches gets applied only
-    for (int revItr=m_highlightOpts.count()-1; revItr>=0; revItr--)
+    for (int revItr=m_highlightOpts.count()-1; revItr>=firstFilter; revItr--)
     {
-        auto highlightOpt = m_highlightOpts[revItr];
+        const SearchOpt& highlightOpt = m_highlightOpts[revItr];
         for (auto key : highlightOpt.m_keys)
         {
             QString columnStr;
@@ -603,25 +908,79 @@ QColor TreeModel::ItemHighlightColor(const QModelIndex& idx) const
                 if (valueStr.isNull())
                 {
                     // Cache value string so it's not calculated for all filters.
-                    valueStr = GetValueFullString(idx, true);
+                    valueStr = ValueSearchString(row);
                 }
                 columnStr = valueStr;
             }
+            else if (key == COL::Time)
+            {
+                // Match the timestamp as logged rather than its microseconds
+                columnStr = Event(row)["ts"].toString();
+            }
             else
             {
-                columnStr = item->Data(key).toString();
+                columnStr = TopLevelData(row, key).toString();
             }
 
             if (highlightOpt.HasMatch(columnStr))
             {
-                m_highlightColorCache.insert(item, highlightOpt.m_backgroundColor);
-                return highlightOpt.m_backgroundColor;
+                return static_cast<qint16>(revItr);
             }
         }
     }
+    return NoHighlight;
+}
 
-    m_highlightColorCache.insert(item, QColor(Qt::transparent));
-    return Qt::transparent;
+/// <summary>
+/// Test every top-level row against all the highlight filters, in parallel. The rows of a paged log
+/// are only parsed where they are shown, so they are tested when they are first painted instead.
+/// </summary>
+void TreeModel::EvaluateHighlights()
+{
+    Trace::Scope scope("EvaluateHighlights");
+    const int count = EventCount();
+    m_highlightIndexes.assign(count, NoHighlight);
+    if (m_highlightOpts.isEmpty())
+        return;
+
+    if (m_pagedEvents)
+    {
+        m_highlightIndexes.assign(count, HighlightNotEvaluated);
+        return;
+    }
+
+    ParallelUtils::ForRanges(count, [this](int first, int last) {
+        for (int row = first; row < last; row++)
+        {
+            m_highlightIndexes[row] = EvaluateHighlight(row, 0);
+        }
+    });
+}
+
+QColor TreeModel::ItemHighlightColor(const QModelIndex& idx) const
+{
+    int highlightIndex = ItemHighlightIndex(idx);
+    return (highlightIndex < 0) ? QColor(Qt::transparent) : m_highlightOpts[highlightIndex].m_backgroundColor;
+}
+
+/// <summary>
+/// Compute the brushes of every highlight filter once, so painting a highlighted cell is a lookup.
+/// </summary>
+void TreeModel::UpdateHighlightPalette()
+{
+    m_highlightPalette.clear();
+    m_highlightPalette.reserve(m_highlightOpts.count());
+    for (const SearchOpt& highlightOpt : m_highlightOpts)
+    {
+        const QColor& highlightColor = highlightOpt.m_backgroundColor;
+        // Pick a White or Black foreground, depending on which one gives better contrast
+        double whiteContrast = ThemeUtils::ContrastRatio(QColor(Qt::white), highlightColor);
+        double blackContrast = ThemeUtils::ContrastRatio(QColor(Qt::black), highlightColor);
+        HighlightBrushes brushes;
+        brushes.foreground = QBrush(whiteContrast > blackContrast ? QColor(Qt::white) : QColor(Qt::black));
+        brushes.background = QBrush(highlightColor);
+        m_highlightPalette.push_back(brushes);
+    }
 }
 
 QString TreeModel::JsonToString(const QJsonValue& json, const bool isSingleLine) const
@@ -673,13 +1032,58 @@ const HighlightOptions& TreeModel::GetHighlightFilters() const
 void TreeModel::SetHighlightFilters(const HighlightOptions& highlightOpts)
 {
     m_highlightOpts = highlightOpts;
-    m_highlightColorCache.clear();
+    UpdateHighlightPalette();
+    EvaluateHighlights();
 }
 
 void TreeModel::AddHighlightFilter(const SearchOpt& filter)
 {
+    Trace::Scope scope("AddHighlightFilter");
     m_highlightOpts.append(filter);
-    m_highlightColorCache.clear();
+    UpdateHighlightPalette();
+
+    if (m_pagedEvents)
+    {
+        EvaluateHighlights();
+        return;
+    }
+
+    // The new filter takes precedence over the existing ones, so only the rows it matches change
+    // color and the rows only need to be tested against it.
+    const qint16 newIndex = static_cast<qint16>(m_highlightOpts.count() - 1);
+    bool indexedKeys = !filter.m_keys.isEmpty();
+    for (COL key : filter.m_keys)
+    {
+        indexedKeys = indexedKeys && ColumnIndex::IsIndexed(key);
+    }
+    if (!indexedKeys)
+    {
+        ParallelUtils::ForRanges(EventCount(), [this, newIndex](int first, int last) {
+            for (int row = first; row < last; row++)
+            {
+                // Rows not evaluated yet get tested against all the filters when first shown
+                if (m_highlightIndexes[row] != HighlightNotEvaluated && EvaluateHighlight(row, newIndex) == newIndex)
+                    m_highlightIndexes[row] = newIndex;
+            }
+        });
+        return;
+    }
+
+    // Match the distinct values of the columns instead of every row
+    for (COL key : filter.m_keys)
+    {
+        const ColumnIndex& index = GetColumnIndex(key);
+        for (const QString& value : index.Values())
+        {
+            if (!filter.HasMatch(value))
+                continue;
+
+            for (int row : index.Rows(value))
+            {
+                m_highlightIndexes[row] = newIndex;
+            }
+        }
+    }
 }
 
 bool TreeModel::HasHighlightFilters() const
@@ -687,6 +1091,116 @@ bool TreeModel::HasHighlightFilters() const
     return m_highlightOpts.count() > 0;
 }
 
+qint64 MemoryUsage::Total() const
+{
+    return events + treeItems + columnIndexes + pathColumns + searchCache + displayCache + rowState;
+}
+
+QString MemoryUsage::ToString() const
+{
+    QLocale locale;
+    return QString("  Events: %1%2\n  Tree items: %3\n  Column indexes: %4\n  Path columns: %5\n"
+                   "  Search cache: %6\n  Display cache: %7\n  Row state: %8\n  Total: %9")
+        .arg(locale.formattedDataSize(events), eventsShared ? QString(" (shared with other tabs)") : QString(),
+             locale.formattedDataSize(treeItems), locale.formattedDataSize(columnIndexes),
+             locale.formattedDataSize(pathColumns), locale.formattedDataSize(searchCache),
+             locale.formattedDataSize(displayCache), locale.formattedDataSize(rowState),
+             locale.formattedDataSize(Total()));
+}
+
+/// <summary>
+/// Estimate the bytes held by each structure of the model. The size of the events is extrapolated
+/// from a sample of them, everything else is counted. When isSampled, the path columns and search
+/// strings are extrapolated from a sample of rows too, which keeps it cheap enough to run on every
+/// update of the status bar.
+/// </summary>
+MemoryUsage TreeModel::GetMemoryUsage(bool isSampled) const
+{
+    MemoryUsage usage;
+    if (m_pagedEvents)
+    {
+        usage.events = m_pagedEvents->MemoryBytes();
+        usage.eventsShared = m_pagedEvents.use_count() > 1;
+    }
+    else
+    {
+        usage.events = static_cast<qint64>(m_allEvents->capacity()) * sizeof(QJsonObject) +
+                       SampledBytes(static_cast<int>(m_allEvents->size()), [this](int i) {
+                           return QJsonUtils::EstimatedSize(m_allEvents->at(i));
+                       });
+        usage.eventsShared = m_allEvents.use_count() > 1;
+    }
+
+    // Only the expanded rows have items, and column indexes hold few distinct values, so they
+    // are always counted
+    usage.treeItems = m_rootItem->MemoryBytes();
+    for (const auto& rowItem : m_detailItems)
+    {
+        // A map node holds the row, the pointer and three links
+        usage.treeItems += rowItem.second->MemoryBytes() + 4 * static_cast<qint64>(sizeof(void*));
+    }
+    for (const auto& columnIndex : m_columnIndexes)
+    {
+        usage.columnIndexes += columnIndex.second.MemoryBytes();
+    }
+
+    if (isSampled)
+    {
+        for (const PathColumn& pathColumn : m_pathColumns)
+        {
+            usage.pathColumns += pathColumn.RowCount() * static_cast<qint64>(sizeof(double) + sizeof(QString)) +
+                                 SampledBytes(pathColumn.RowCount(), [&pathColumn](int row) {
+                                     return (pathColumn.HasValue(row) && !pathColumn.IsNumber(row))
+                                         ? pathColumn.Data(row).toString().size() * static_cast<qint64>(sizeof(QChar))
+                                         : 0;
+                                 });
+        }
+        usage.searchCache = m_valueSearchStrings.capacity() * sizeof(QString) +
+                            SampledBytes(static_cast<int>(m_valueSearchStrings.size()), [this](int row) {
+                                return m_valueSearchStrings[row].size() * static_cast<qint64>(sizeof(QChar));
+                            });
+    }
+    else
+    {
+        for (const PathColumn& pathColumn : m_pathColumns)
+        {
+            usage.pathColumns += pathColumn.MemoryBytes();
+        }
+        usage.searchCache = m_valueSearchStrings.capacity() * sizeof(QString);
+        for (const QString& searchStr : m_valueSearchStrings)
+        {
+            usage.searchCache += searchStr.size() * sizeof(QChar);
+        }
+    }
+
+    // Time texts are about 30 characters, and cells mostly short texts
+    usage.displayCache = m_timeDisplayCache.size() * (sizeof(QString) + 30 * sizeof(QChar)) +
+                         m_rowCells.size() * static_cast<qint64>(columnCount()) * (sizeof(QVariant) + 16 * sizeof(QChar));
+
+    usage.rowState = m_highlightIndexes.capacity() * sizeof(qint16) +
+                     m_hiddenRows.capacity() / 8 +
+                     (m_sortOrder.capacity() + m_sortRank.capacity() + m_storeRows.capacity()) * sizeof(int);
+    for (const auto& hiddenRows : m_hideUndoStack)
+    {
+        usage.rowState += hiddenRows.capacity() * sizeof(int);
+    }
+    return usage;
+}
+
+/// <summary>
+/// Free the caches that are rebuilt on use: search strings, display texts, column indexes and
+/// the parsed pages of a paged log. Highlights keep their evaluated state.
+/// </summary>
+void TreeModel::DropCaches()
+{
+    m_valueSearchStrings.assign(m_valueSearchStrings.size(), QString());
+    m_rowCells.clear();
+    m_timeDisplayCache.clear();
+    m_columnIndexes.clear();
+    if (m_pagedEvents)
+        m_pagedEvents->DropPages();
+}
+
 bool TreeModel::ValidFindOpts()
 {
     return m_findOpts.m_keys.count() > 0 && m_findOpts.m_value != "";
@@ -694,13 +1208,411 @@ bool TreeModel::ValidFindOpts()
 
 void TreeModel::ClearAllEvents()
 {
-    m_allEvents->clear();
-    m_highlightColorCache.clear();
+    if (!m_storeRows.empty() || m_pagedEvents || m_allEvents.use_count() > 1)
+    {
+        // Leave the shared list to the other models
+        m_allEvents = std::make_shared<EventList>();
+        m_storeRows.clear();
+        m_pagedEvents.reset();
+    }
+    else
+    {
+        m_allEvents->clear();
+    }
+    ClearDetailItems();
+    m_highlightIndexes.clear();
+    m_hiddenRows.clear();
+    m_hiddenRowCount = 0;
+    m_hideUndoStack.clear();
+    m_columnIndexes.clear();
+    m_valueSearchStrings.clear();
+    m_rowCells.clear();
+    m_sortOrder.clear();
+    m_sortRank.clear();
+    for (auto& pathColumn : m_pathColumns)
+    {
+        pathColumn.Clear();
+    }
+}
+
+void TreeModel::RemoveRowState(int position, int count)
+{
+    auto first = m_hiddenRows.begin() + position;
+    m_hiddenRowCount -= static_cast<int>(std::count(first, first + count, true));
+    m_hiddenRows.erase(first, first + count);
+    if (!m_pagedEvents)
+        m_valueSearchStrings.erase(m_valueSearchStrings.begin() + position, m_valueSearchStrings.begin() + position + count);
+    m_rowCells.clear();
+    m_highlightIndexes.erase(m_highlightIndexes.begin() + position, m_highlightIndexes.begin() + position + count);
+    for (auto& pathColumn : m_pathColumns)
+    {
+        pathColumn.RemoveRows(position, count);
+    }
+
+    for (auto& hiddenRows : m_hideUndoStack)
+    {
+        auto removed = std::remove_if(hiddenRows.begin(), hiddenRows.end(), [position, count](int row) {
+            return row >= position && row < position + count;
+        });
+        hiddenRows.erase(removed, hiddenRows.end());
+        for (int& row : hiddenRows)
+        {
+            if (row >= position + count)
+                row -= count;
+        }
+    }
+    std::map<int, TreeItem*> detailItems;
+    for (const auto& rowItem : m_detailItems)
+    {
+        if (rowItem.first < position)
+        {
+            detailItems.emplace_hint(detailItems.end(), rowItem.first, rowItem.second);
+        }
+        else if (rowItem.first >= position + count)
+        {
+            rowItem.second->SetData(0, rowItem.first - count);
+            detailItems.emplace_hint(detailItems.end(), rowItem.first - count, rowItem.second);
+        }
+        else
+        {
+            delete rowItem.second;
+        }
+    }
+    m_detailItems.swap(detailItems);
+
+    m_hideUndoStack.erase(
+        std::remove_if(m_hideUndoStack.begin(), m_hideUndoStack.end(), [](const std::vector<int>& rows) {
+            return rows.empty();
+        }),
+        m_hideUndoStack.end());
+
+    m_columnIndexes.clear();
+}
+
+/// <summary>
+/// Promote a JSON path of the events (e.g. "v.elapsed") to a column after the fixed ones.
+/// The values of all the current events are extracted in parallel; later events are extracted as they come in.
+/// Returns the column, which is the existing one if the path was already promoted.
+/// </summary>
+int TreeModel::AddPathColumn(const QString& path)
+{
+    const int firstPathColumn = m_rootItem->ColumnCount();
+    for (int i = 0; i < static_cast<int>(m_pathColumns.size()); i++)
+    {
+        if (m_pathColumns[i].Path() == path.trimmed())
+            return firstPathColumn + i;
+    }
+
+    PathColumn pathColumn(path);
+    pathColumn.Build(EventCount(), [this](int row) { return Event(row); });
+
+    const int column = columnCount();
+    beginInsertColumns(QModelIndex(), column, column);
+    m_pathColumns.push_back(std::move(pathColumn));
+    endInsertColumns();
+    return column;
+}
+
+void TreeModel::RemovePathColumn(int column)
+{
+    if (!GetPathColumn(column))
+        return;
+
+    beginRemoveColumns(QModelIndex(), column, column);
+    m_pathColumns.erase(m_pathColumns.begin() + (column - m_rootItem->ColumnCount()));
+    endRemoveColumns();
+}
+
+const PathColumn* TreeModel::GetPathColumn(int column) const
+{
+    int pathIndex = column - m_rootItem->ColumnCount();
+    if (pathIndex < 0 || pathIndex >= static_cast<int>(m_pathColumns.size()))
+        return nullptr;
+    return &m_pathColumns[pathIndex];
+}
+
+const ColumnIndex& TreeModel::GetColumnIndex(COL column) const
+{
+    ColumnIndex& index = m_columnIndexes[column];
+    if (!index.IsBuilt())
+    {
+        const int count = EventCount();
+        for (int row = 0; row < count; row++)
+        {
+            index.Add(TopLevelData(row, column).toString(), row);
+        }
+        index.SetBuilt();
+    }
+    return index;
+}
+
+void TreeModel::UpdateColumnIndexes(const std::vector<int>& rows)
+{
+    if (m_columnIndexes.empty())
+        return;
+
+    // Appending keeps the row lists sorted, which is the common case while live capturing.
+    // Inserting in the middle shifts rows, so the indexes get rebuilt on next use instead.
+    if (rows.front() != EventCount() - static_cast<int>(rows.size()))
+    {
+        m_columnIndexes.clear();
+        return;
+    }
+
+    for (auto& columnIndex : m_columnIndexes)
+    {
+        if (columnIndex.second.IsBuilt())
+        {
+            for (int row : rows)
+            {
+                columnIndex.second.Add(TopLevelData(row, columnIndex.first).toString(), row);
+            }
+        }
+    }
+}
+
+std::vector<int> TreeModel::RowsWithValue(COL column, const QString& value) const
+{
+    return ToViewRows(GetColumnIndex(column).Rows(value));
+}
+
+std::vector<int> TreeModel::RowsWithValues(COL column, const QSet<QString>& values) const
+{
+    return ToViewRows(GetColumnIndex(column).Rows(values));
+}
+
+/// <summary>
+/// Map rows of the original order to the rows shown, keeping the result sorted.
+/// </summary>
+std::vector<int> TreeModel::ToViewRows(const std::vector<int>& storageRows) const
+{
+    std::vector<int> rows(storageRows);
+    if (IsSorted())
+    {
+        for (int& row : rows)
+        {
+            row = m_sortRank[row];
+        }
+        std::sort(rows.begin(), rows.end());
+    }
+    return rows;
+}
+
+bool TreeModel::IsSorted() const
+{
+    return !m_sortOrder.empty();
+}
+
+EventListPtr TreeModel::GetEventStore() const
+{
+    return m_allEvents;
+}
+
+PagedEventsPtr TreeModel::GetPagedEvents() const
+{
+    return m_pagedEvents;
+}
+
+int TreeModel::StoreRow(int storageRow) const
+{
+    if (m_storeRows.empty())
+        return storageRow;
+    return m_storeRows[storageRow];
+}
+
+QJsonObject TreeModel::Event(int row) const
+{
+    if (m_pagedEvents)
+        return m_pagedEvents->At(StoreRow(row));
+    return m_allEvents->at(StoreRow(row));
+}
+
+int TreeModel::EventCount() const
+{
+    if (!m_storeRows.empty())
+        return static_cast<int>(m_storeRows.size());
+    return m_pagedEvents ? m_pagedEvents->Count() : static_cast<int>(m_allEvents->size());
+}
+
+/// <summary>
+/// Give the model a list of events of its own before changing it. A model of some rows of a shared
+/// list copies those rows, and a model whose list is shared copies the whole list. Either way only
+/// references to the events are copied, the events themselves are implicitly shared.
+/// A paged model loads all of its events, which is why paged tabs are never merged into or tailed.
+/// </summary>
+void TreeModel::DetachEvents()
+{
+    if (!m_storeRows.empty() || m_pagedEvents)
+    {
+        auto events = std::make_shared<EventList>();
+        const int count = EventCount();
+        // Search strings are cached once the events are in memory
+        if (m_pagedEvents)
+            m_valueSearchStrings.resize(count);
+        events->reserve(count);
+        for (int row = 0; row < count; row++)
+        {
+            events->append(Event(row));
+        }
+        m_allEvents = events;
+        m_storeRows.clear();
+        m_pagedEvents.reset();
+    }
+    else if (m_allEvents.use_count() > 1)
+    {
+        m_allEvents = std::make_shared<EventList>(*m_allEvents);
+    }
+}
+
+int TreeModel::StorageRow(int row) const
+{
+    if (m_sortOrder.empty() || row < 0 || row >= static_cast<int>(m_sortOrder.size()))
+        return row;
+    return m_sortOrder[row];
+}
+
+int TreeModel::ViewRow(int storageRow) const
+{
+    if (m_sortRank.empty() || storageRow < 0 || storageRow >= static_cast<int>(m_sortRank.size()))
+        return storageRow;
+    return m_sortRank[storageRow];
+}
+
+/// <summary>
+/// Sort the top-level rows by a column. Only a permutation of the rows is computed, the events and
+/// the tree items stay where they are. The sort is stable so equal values keep their original order,
+/// and rows without a value go last. A negative column restores the original order.
+/// </summary>
+void TreeModel::sort(int column, Qt::SortOrder order)
+{
+    Trace::Scope scope("Sort");
+    const int count = EventCount();
+    if (column < 0 || column >= columnCount() || count == 0)
+    {
+        SetSortOrder(std::vector<int>());
+        return;
+    }
+
+    std::vector<int> sortOrder(count);
+    std::iota(sortOrder.begin(), sortOrder.end(), 0);
+    const bool descending = (order == Qt::DescendingOrder);
+    const PathColumn* pathColumn = GetPathColumn(column);
+
+    bool isNumeric = (column == COL::ID || column == COL::PID || column == COL::Elapsed);
+    if (pathColumn)
+    {
+        for (int row = 0; row < count && !isNumeric; row++)
+        {
+            isNumeric = pathColumn->IsNumber(row);
+        }
+    }
+
+    if (column == COL::Time)
+    {
+        const qint64 NoTime = std::numeric_limits<qint64>::max();
+        std::vector<qint64> keys(count);
+        ParallelUtils::ForRanges(count, [this, &keys, NoTime](int first, int last) {
+            for (int row = first; row < last; row++)
+            {
+                QVariant usecs = TopLevelData(row, COL::Time);
+                keys[row] = usecs.isValid() ? usecs.toLongLong() : NoTime;
+            }
+        });
+        ParallelUtils::StableSort(sortOrder, [&keys, descending, NoTime](int a, int b) {
+            if (keys[a] == NoTime || keys[b] == NoTime)
+                return keys[b] == NoTime && keys[a] != NoTime;
+            return descending ? keys[b] < keys[a] : keys[a] < keys[b];
+        });
+    }
+    else if (isNumeric)
+    {
+        std::vector<double> keys(count);
+        ParallelUtils::ForRanges(count, [this, &keys, column, pathColumn](int first, int last) {
+            for (int row = first; row < last; row++)
+            {
+                if (pathColumn)
+                {
+                    keys[row] = pathColumn->Number(row);
+                    continue;
+                }
+                QVariant data = TopLevelData(row, column);
+                keys[row] = data.isValid() ? data.toDouble() : std::numeric_limits<double>::quiet_NaN();
+            }
+        });
+        ParallelUtils::StableSort(sortOrder, [&keys, descending](int a, int b) {
+            if (std::isnan(keys[a]) || std::isnan(keys[b]))
+                return std::isnan(keys[b]) && !std::isnan(keys[a]);
+            return descending ? keys[b] < keys[a] : keys[a] < keys[b];
+        });
+    }
+    else
+    {
+        std::vector<QString> keys(count);
+        ParallelUtils::ForRanges(count, [this, &keys, column, pathColumn](int first, int last) {
+            for (int row = first; row < last; row++)
+            {
+                keys[row] = pathColumn ?
+                    pathColumn->DisplayString(row) :
+                    TopLevelData(row, column).toString();
+            }
+        });
+        ParallelUtils::StableSort(sortOrder, [&keys, descending](int a, int b) {
+            if (keys[a].isEmpty() || keys[b].isEmpty())
+                return keys[b].isEmpty() && !keys[a].isEmpty();
+            int compare = keys[a].compare(keys[b], Qt::CaseInsensitive);
+            return descending ? compare > 0 : compare < 0;
+        });
+    }
+
+    SetSortOrder(std::move(sortOrder));
+}
+
+/// <summary>
+/// Switch to a new order of the top-level rows, an empty one being the original order.
+/// Persistent indexes (selection, current row, rows hidden by the view) follow their rows.
+/// </summary>
+void TreeModel::SetSortOrder(std::vector<int> sortOrder)
+{
+    if (sortOrder.empty() && m_sortOrder.empty())
+        return;
+
+    emit layoutAboutToBeChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+
+    // Only the top-level rows move
+    const QModelIndexList oldIndexes = persistentIndexList();
+    std::vector<int> storageRows(oldIndexes.size(), -1);
+    for (int i = 0; i < oldIndexes.size(); i++)
+    {
+        if (IsTopLevel(oldIndexes[i]))
+            storageRows[i] = StorageRow(oldIndexes[i].row());
+    }
+
+    m_sortOrder = std::move(sortOrder);
+    m_sortRank.assign(m_sortOrder.size(), 0);
+    for (int row = 0; row < static_cast<int>(m_sortOrder.size()); row++)
+    {
+        m_sortRank[m_sortOrder[row]] = row;
+    }
+
+    QModelIndexList newIndexes;
+    newIndexes.reserve(oldIndexes.size());
+    for (int i = 0; i < oldIndexes.size(); i++)
+    {
+        const QModelIndex& oldIndex = oldIndexes[i];
+        newIndexes.append((storageRows[i] < 0) ?
+            oldIndex :
+            createIndex(ViewRow(storageRows[i]), oldIndex.column(), oldIndex.internalPointer()));
+    }
+    changePersistentIndexList(oldIndexes, newIndexes);
+
+    Trace::Scope scope("layoutChanged");
+    emit layoutChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
 }
 
 void TreeModel::SetTimeMode(TimeMode mode)
 {
     m_timeMode = mode;
+    m_timeDisplayCache.clear();
 }
 
 TimeMode TreeModel::GetTimeMode() const
@@ -712,24 +1624,33 @@ void TreeModel::ShowDeltas(qint64 delta)
 {
     m_timeMode = TimeMode::TimeDeltas;
     m_deltaBase = delta;
+    m_timeDisplayCache.clear();
 }
 
-QString TreeModel::GetDeltaMSecs(QDateTime dateTime) const
+/// <summary>
+/// Text of the Time column in the current time mode. Repaints ask for the same rows over and over,
+/// so the text is cached by timestamp until the time mode changes.
+/// </summary>
+QString TreeModel::GetTimeDisplayString(qint64 usecs) const
 {
-    auto msecs = dateTime.toMSecsSinceEpoch() - m_deltaBase;
-    bool isNegative = msecs < 0;
-    msecs = msecs < 0 ? -msecs : msecs;
-    int hours = msecs/(1000*60*60);
-    int minutes = (msecs-(hours*1000*60*60))/(1000*60);
-    int seconds = (msecs-(minutes*1000*60)-(hours*1000*60*60))/1000;
-    int milliseconds = msecs-(seconds*1000)-(minutes*1000*60)-(hours*1000*60*60);
+    if (const QString* cached = m_timeDisplayCache.object(usecs))
+        return *cached;
 
-    return QString("%1%2:%3:%4.%5")
-        .arg(isNegative ? "-" : "")
-        .arg(hours, 2, 10, QLatin1Char('0'))
-        .arg(minutes, 2, 10, QLatin1Char('0'))
-        .arg(seconds, 2, 10, QLatin1Char('0'))
-        .arg(milliseconds, 3, 10, QLatin1Char('0'));
+    QString text;
+    switch (m_timeMode)
+    {
+       case TimeMode::GlobalDateTime:
+          text = TimeUtils::FormatDateTime(usecs);
+          break;
+       case TimeMode::GlobalTime:
+          text = TimeUtils::FormatTime(usecs);
+          break;
+       case TimeMode::TimeDeltas:
+          text = TimeUtils::FormatDuration(usecs - m_deltaBase);
+          break;
+    }
+    m_timeDisplayCache.insert(usecs, new QString(text));
+    return text;
 }
 
 bool TreeModel::IsHighlightedRow(int row) const
@@ -738,3 +1659,80 @@ bool TreeModel::IsHighlightedRow(int row) const
     bool highlighted = (ItemHighlightColor(idx) != Qt::transparent);
     return highlighted;
 }
+
+bool TreeModel::IsHiddenRow(int row) const
+{
+    row = StorageRow(row);
+    return row >= 0 && row < static_cast<int>(m_hiddenRows.size()) && m_hiddenRows[row];
+}
+
+int TreeModel::HiddenRowCount() const
+{
+    return m_hiddenRowCount;
+}
+
+/// <summary>
+/// Hide top-level rows without removing them from the model. Rows that are already hidden
+/// are ignored. The rows hidden by this call can be restored with UndoHide.
+/// Returns the number of rows that got hidden.
+/// </summary>
+int TreeModel::HideRows(const QVector<int>& rows)
+{
+    const int MaxHideUndoLevels = 100;
+
+    std::vector<int> hiddenRows;
+    hiddenRows.reserve(rows.size());
+    for (int viewRow : rows)
+    {
+        int row = StorageRow(viewRow);
+        if (row < 0 || row >= static_cast<int>(m_hiddenRows.size()) || m_hiddenRows[row])
+            continue;
+
+        m_hiddenRows[row] = true;
+        hiddenRows.push_back(row);
+    }
+
+    int count = static_cast<int>(hiddenRows.size());
+    if (count > 0)
+    {
+        m_hiddenRowCount += count;
+        m_hideUndoStack.push_back(std::move(hiddenRows));
+        if (static_cast<int>(m_hideUndoStack.size()) > MaxHideUndoLevels)
+        {
+            m_hideUndoStack.erase(m_hideUndoStack.begin());
+        }
+    }
+    return count;
+}
+
+/// <summary>
+/// Unhide the rows hidden by the last HideRows call. Returns the rows that are visible again.
+/// </summary>
+std::vector<int> TreeModel::UndoHide()
+{
+    if (m_hideUndoStack.empty())
+        return std::vector<int>();
+
+    std::vector<int> rows = std::move(m_hideUndoStack.back());
+    m_hideUndoStack.pop_back();
+    for (int row : rows)
+    {
+        m_hiddenRows[row] = false;
+    }
+    m_hiddenRowCount -= static_cast<int>(rows.size());
+    return ToViewRows(rows);
+}
+
+int TreeModel::UnhideAll()
+{
+    int count = m_hiddenRowCount;
+    std::fill(m_hiddenRows.begin(), m_hiddenRows.end(), false);
+    m_hiddenRowCount = 0;
+    m_hideUndoStack.clear();
+    return count;
+}
+
+bool TreeModel::CanUndoHide() const
+{
+    return !m_hideUndoStack.empty();
+}
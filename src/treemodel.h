@@ -2,16 +2,26 @@
 #define TREEMODEL_H
 
 #include "colorlibrary.h"
+#include "columnindex.h"
 #include "highlightoptions.h"
+#include "loadfilter.h"
+#include "pagedevents.h"
+#include "pathcolumn.h"
 #include "searchopt.h"
+#include "timeindex.h"
 
+#include <map>
 #include <memory>
 #include <QAbstractItemModel>
+#include <QBrush>
+#include <QByteArray>
+#include <QCache>
 #include <QColor>
 #include <QHash>
 #include <QJsonObject>
 #include <QModelIndex>
 #include <QVariant>
+#include <QVector>
 #include <queue>
 #include <utility>
 #include <vector>
@@ -24,7 +34,46 @@ typedef std::shared_ptr<EventList> EventListPtr;
 enum class TABTYPE {
     SingleFile = 0,
     Directory,
-    ExportedEvents
+    ExportedEvents,
+    LogTree,
+    TimeRange
+};
+
+// How much of a log file the events of a model were read from, so a refresh can tell
+// appended lines from a file that was rewritten
+struct FileReadState
+{
+    qint64 size = 0;
+    // Length and hash of the start of the file when it was first read
+    qint64 headSize = 0;
+    QByteArray headHash;
+    // Non-empty lines read, which numbers the "idx" of the next event
+    int lineCount = 0;
+    // Events the model got from the file
+    int eventCount = 0;
+};
+
+// Estimated bytes held by the structures of a model
+struct MemoryUsage
+{
+    // Parsed events, or the line positions and parsed pages of a paged log
+    qint64 events = 0;
+    // Other tabs exported from the same events, or that these were exported from
+    bool eventsShared = false;
+    // Detail rows built when top-level rows are expanded
+    qint64 treeItems = 0;
+    // Value to rows lookups of the fixed columns
+    qint64 columnIndexes = 0;
+    qint64 pathColumns = 0;
+    // Compact JSON of the values that find and highlight matched
+    qint64 searchCache = 0;
+    // Time column text and cells of the rows last drawn
+    qint64 displayCache = 0;
+    // Highlight, hidden and sort state of each row, and the hide undo history
+    qint64 rowState = 0;
+
+    qint64 Total() const;
+    QString ToString() const;
 };
 
 enum class TimeMode {
@@ -39,6 +88,8 @@ class TreeModel : public QAbstractItemModel
 
 public:
     TreeModel(const QStringList &headers, const EventListPtr events, QObject *parent = 0);
+    TreeModel(const QStringList &headers, const EventListPtr events, std::vector<int> rows, QObject *parent = 0);
+    TreeModel(const QStringList &headers, const PagedEventsPtr events, std::vector<int> rows, QObject *parent = 0);
     ~TreeModel();
 
     QVariant data(const QModelIndex &index, int role) const override;
@@ -47,6 +98,7 @@ public:
     QModelIndex parent(const QModelIndex &index) const override;
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
 
     Qt::ItemFlags flags(const QModelIndex &index) const override;
@@ -57,6 +109,7 @@ public:
     bool removeColumns(int position, int columns, const QModelIndex &parent = QModelIndex()) override;
     bool insertRows(int position, int rows, const QModelIndex &parent = QModelIndex()) override;
     bool removeRows(int position, int rows, const QModelIndex &parent = QModelIndex()) override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
 
     QString GetChildValueString(const QModelIndex &index, QString key) const;
     int MergeIntoModelData(const EventList& events);
@@ -67,41 +120,130 @@ public:
     TimeMode GetTimeMode() const;
     void ShowDeltas(qint64 delta);
     bool IsHighlightedRow(int row) const;
+    bool IsHiddenRow(int row) const;
+    int HiddenRowCount() const;
+    int HideRows(const QVector<int>& rows);
+    std::vector<int> UndoHide();
+    int UnhideAll();
+    bool CanUndoHide() const;
+    bool IsSorted() const;
+    int StorageRow(int row) const;
+    int ViewRow(int storageRow) const;
+    EventListPtr GetEventStore() const;
+    PagedEventsPtr GetPagedEvents() const;
+    int StoreRow(int storageRow) const;
+    std::vector<int> RowsWithValue(COL column, const QString& value) const;
+    std::vector<int> RowsWithValues(COL column, const QSet<QString>& values) const;
+    int AddPathColumn(const QString& path);
+    void RemovePathColumn(int column);
+    const PathColumn* GetPathColumn(int column) const;
     QJsonObject GetEvent(QModelIndex idx) const;
     QJsonValue GetConsolidatedEventContent(QModelIndex idx) const;
     QString GetValueFullString(const QModelIndex& idx, bool singleLineFormat = false) const;
+    QString GetValueSearchString(const QModelIndex& idx) const;
+    void ClearSearchCache();
     TABTYPE TabType() const;
     void SetTabType(TABTYPE type);
     const HighlightOptions& GetHighlightFilters() const;
     void SetHighlightFilters(const HighlightOptions& highlightOpts);
     void AddHighlightFilter(const SearchOpt& filter);
     bool HasHighlightFilters() const;
+    MemoryUsage GetMemoryUsage(bool isSampled = false) const;
+    void DropCaches();
 
     bool m_highlightOnlyMode;
     bool m_liveMode;
     ColorLibrary m_colorLibrary;
     SearchOpt m_findOpts;
     QList<QString> m_paths;
+    QHash<QString, FileReadState> m_readStates;
+    // Events the files of the tab are read with, on open, refresh and live capture
+    LoadFilter m_loadFilter;
+    // Window of a time range tab, in microseconds since the epoch
+    qint64 m_rangeStart = 0;
+    qint64 m_rangeEnd = 0;
+    // Time index samples of the file of a time range tab, which refresh reads the window with
+    std::vector<TimeIndex::Sample> m_rangeSamples;
 
 private:
-    void SetupModelData(TreeItem *parent);
-    void SetupChild(TreeItem *parent, const QJsonObject & event);
-    void AddChildren(QJsonObject &obj, TreeItem *parent);
-    void AddChild(const QString& key, const QJsonValue& value, TreeItem* parent);
-    void InsertChild(int position, const QJsonObject & event);
+    void Init(const QStringList &headers);
+    QVariant TopLevelData(int row, int column) const;
+    QVariant CellData(const QModelIndex& idx) const;
+    bool IsTopLevel(const QModelIndex& idx) const;
+    TreeItem* DetailsItem(int row) const;
+    void ClearDetailItems();
+    void AddChildren(QJsonObject &obj, TreeItem *parent) const;
+    void AddChild(const QString& key, const QJsonValue& value, TreeItem* parent) const;
+    QJsonObject Event(int row) const;
+    int EventCount() const;
+    void DetachEvents();
+    void InsertEvents(const EventList& events, const std::vector<int>& rows);
+    void RemoveRowState(int position, int count);
+    const ColumnIndex& GetColumnIndex(COL column) const;
+    void UpdateColumnIndexes(const std::vector<int>& rows);
+    std::vector<int> ToViewRows(const std::vector<int>& storageRows) const;
+    void SetSortOrder(std::vector<int> sortOrder);
     QString JsonToString(const QJsonValue& json, const bool isSingleLine = true) const;
     QJsonValue ConsolidateValueAndActivity(const QJsonObject& event) const;
+    int ItemHighlightIndex(const QModelIndex& idx) const;
+    qint16 EvaluateHighlight(int row, int firstFilter) const;
+    void EvaluateHighlights();
+    QString ValueSearchString(int row) const;
+    QString RawValueSearchString(int row) const;
     QColor ItemHighlightColor(const QModelIndex& idx) const;
-    QString GetDeltaMSecs(QDateTime dateTime) const;
+    void UpdateHighlightPalette();
+    QString GetTimeDisplayString(qint64 usecs) const;
     TreeItem *GetItem(const QModelIndex &index) const;
 
+    // Holds the headers. Top-level rows have no items: their indexes have no pointer, and their
+    // cells come from the events.
     TreeItem * m_rootItem;
+    // Items holding the nested rows of the top-level rows that were expanded, by row of m_allEvents
+    mutable std::map<int, TreeItem*> m_detailItems;
     TimeMode m_timeMode = TimeMode::GlobalDateTime;
+    // Microseconds since the epoch of the event the deltas are relative to
     qint64 m_deltaBase = 0;
+    // Time column text by timestamp, sized well above the rows that fit on screen
+    mutable QCache<qint64, QString> m_timeDisplayCache{4096};
     EventListPtr m_allEvents;
+    // Rows of m_allEvents the model shows, for tabs exported from another tab. Empty when the model
+    // shows the whole list. Rows everywhere else in the model are rows of this list.
+    std::vector<int> m_storeRows;
+    // Events of a paged log, used instead of m_allEvents when set
+    PagedEventsPtr m_pagedEvents;
     TABTYPE m_fileType;
     HighlightOptions m_highlightOpts;
-    mutable QHash<TreeItem*, QColor> m_highlightColorCache;
+    // Index of the highlight filter matching each top-level row, -1 for none and -2 for rows
+    // that were added since the filters were last evaluated
+    mutable std::vector<qint16> m_highlightIndexes;
+    struct HighlightBrushes
+    {
+        QBrush foreground;
+        QBrush background;
+    };
+    // Brushes of each highlight filter, in the order of m_highlightOpts
+    std::vector<HighlightBrushes> m_highlightPalette;
+
+    // Hidden top-level rows. Hiding never touches the events or the tree items, so
+    // hidden events can be brought back at any time without reloading the file.
+    std::vector<bool> m_hiddenRows;
+    int m_hiddenRowCount = 0;
+    // Each entry is the list of rows that a single hide operation hid
+    std::vector<std::vector<int>> m_hideUndoStack;
+    // Value to rows lookup of the fixed columns, built on first use
+    mutable std::map<COL, ColumnIndex> m_columnIndexes;
+    // Top-level rows as shown, given as rows of m_allEvents and of the root item children.
+    // Empty while the events are in their original order. Sorting never moves the events or
+    // the tree items, and all the per-row state above stays in the original order.
+    std::vector<int> m_sortOrder;
+    // Inverse of m_sortOrder
+    std::vector<int> m_sortRank;
+    // Columns promoted from JSON paths, shown after the fixed columns
+    std::vector<PathColumn> m_pathColumns;
+    // Compact JSON of each top-level value, built on first search. A null string is not built yet.
+    mutable std::vector<QString> m_valueSearchStrings;
+    // Cells of the top-level rows last drawn, by row of m_allEvents. Comfortably more than a screen.
+    mutable QCache<int, QVector<QVariant>> m_rowCells{2048};
 };
 
 #endif // TREEMODEL_H
@@ -0,0 +1,33 @@
+#ifndef VECTORUTILS_H
+#define VECTORUTILS_H
+
+#include <QtGlobal>
+#include <utility>
+#include <vector>
+
+namespace VectorUtils
+{
+    // Makes room for new entries at rows, which are sorted and counted after the insertion, and
+    // sets the i-th of them to makeValue(i). Works on std::vector and QList. Every entry moves at
+    // most once, so a batch costs one pass over the container instead of one per inserted row.
+    template <typename Container, typename MakeValue>
+    void InsertAtRows(Container& values, const std::vector<int>& rows, MakeValue makeValue)
+    {
+        qsizetype from = static_cast<qsizetype>(values.size());
+        qsizetype to = from + static_cast<qsizetype>(rows.size());
+        values.resize(to);
+        for (qsizetype i = static_cast<qsizetype>(rows.size()) - 1; i >= 0; i--)
+        {
+            const qsizetype row = rows[i];
+            while (to > row + 1)
+            {
+                --to;
+                --from;
+                values[to] = std::move(values[from]);
+            }
+            values[--to] = makeValue(static_cast<int>(i));
+        }
+    }
+}
+
+#endif // VECTORUTILS_H
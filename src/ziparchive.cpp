@@ -0,0 +1,236 @@
+#include "ziparchive.h"
+
+#include <algorithm>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace
+{
+    const quint32 LocalHeaderSignature = 0x04034b50;
+    const quint32 CentralHeaderSignature = 0x02014b50;
+    const quint32 Zip64EndSignature = 0x06064b50;
+    const quint32 Zip64LocatorSignature = 0x07064b50;
+    const int LocalHeaderSize = 30;
+    const int EndSize = 22;
+    const int Zip64LocatorSize = 20;
+    const int Zip64EndSize = 56;
+    const quint16 Zip64ExtraId = 0x0001;
+    const quint16 EncryptedFlag = 0x0001;
+    const quint16 Utf8Flag = 0x0800;
+    const quint32 Overflow32 = 0xFFFFFFFF;
+
+    QByteArray ReadAt(QFile& file, qint64 offset, qint64 size)
+    {
+        if (offset < 0 || !file.seek(offset))
+            return QByteArray();
+        QByteArray data = file.read(size);
+        return (data.size() == size) ? data : QByteArray();
+    }
+
+    // Where the central directory is and how many entries it has. The end record is at the end of
+    // the archive, before a comment of up to 64K.
+    bool ReadEnd(QFile& file, qint64& directoryOffset, qint64& directorySize, qint64& entryCount)
+    {
+        const qint64 fileSize = file.size();
+        const qint64 tailSize = std::min<qint64>(fileSize, EndSize + 0xFFFF);
+        const QByteArray tail = ReadAt(file, fileSize - tailSize, tailSize);
+        const qsizetype endPos = tail.lastIndexOf(QByteArray("PK\x05\x06", 4));
+        if (endPos < 0 || endPos + EndSize > tail.size())
+            return false;
+
+        QDataStream end(tail.mid(endPos));
+        end.setByteOrder(QDataStream::LittleEndian);
+        quint32 magic;
+        quint16 disk, directoryDisk, diskEntries, entries;
+        quint32 size, offset;
+        end >> magic >> disk >> directoryDisk >> diskEntries >> entries >> size >> offset;
+        directoryOffset = offset;
+        directorySize = size;
+        entryCount = entries;
+        if (entries != 0xFFFF && size != Overflow32 && offset != Overflow32)
+            return true;
+
+        // Zip64 archives keep the real values in a record found through a locator before the end record
+        const qint64 locatorOffset = fileSize - tailSize + endPos - Zip64LocatorSize;
+        QDataStream locator(ReadAt(file, locatorOffset, Zip64LocatorSize));
+        locator.setByteOrder(QDataStream::LittleEndian);
+        quint32 locatorDisk, diskCount;
+        qint64 zip64EndOffset;
+        locator >> magic >> locatorDisk >> zip64EndOffset >> diskCount;
+        if (locator.status() != QDataStream::Ok || magic != Zip64LocatorSignature)
+            return false;
+
+        QDataStream zip64End(ReadAt(file, zip64EndOffset, Zip64EndSize));
+        zip64End.setByteOrder(QDataStream::LittleEndian);
+        qint64 recordSize, diskEntries64;
+        quint16 versionMadeBy, versionNeeded;
+        quint32 disk64, directoryDisk64;
+        zip64End >> magic >> recordSize >> versionMadeBy >> versionNeeded >> disk64 >> directoryDisk64
+                 >> diskEntries64 >> entryCount >> directorySize >> directoryOffset;
+        return zip64End.status() == QDataStream::Ok && magic == Zip64EndSignature;
+    }
+
+    struct CachedArchive
+    {
+        QString path;
+        qint64 size = -1;
+        QDateTime modified;
+        QHash<QString, ZipArchive::Member> members;
+    };
+}
+
+namespace ZipArchive
+{
+    bool IsZip(const QString& path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+
+        QByteArray magic = file.read(4);
+        return magic == QByteArray("PK\x03\x04", 4);
+    }
+
+    std::vector<Member> ReadMembers(const QString& zipPath)
+    {
+        std::vector<Member> members;
+        QFile file(zipPath);
+        qint64 directoryOffset, directorySize, entryCount;
+        if (!file.open(QIODevice::ReadOnly) || !ReadEnd(file, directoryOffset, directorySize, entryCount))
+            return members;
+
+        QDataStream directory(ReadAt(file, directoryOffset, directorySize));
+        directory.setByteOrder(QDataStream::LittleEndian);
+        for (qint64 i = 0; i < entryCount; i++)
+        {
+            quint32 magic, crc, compressedSize32, size32, externalAttributes, headerOffset32;
+            quint16 versionMadeBy, versionNeeded, flags, method, time, date, nameLength, extraLength, commentLength,
+                    diskStart, internalAttributes;
+            directory >> magic >> versionMadeBy >> versionNeeded >> flags >> method >> time >> date >> crc
+                      >> compressedSize32 >> size32 >> nameLength >> extraLength >> commentLength
+                      >> diskStart >> internalAttributes >> externalAttributes >> headerOffset32;
+            if (directory.status() != QDataStream::Ok || magic != CentralHeaderSignature)
+                break;
+
+            QByteArray name(nameLength, Qt::Uninitialized);
+            QByteArray extra(extraLength, Qt::Uninitialized);
+            directory.readRawData(name.data(), nameLength);
+            directory.readRawData(extra.data(), extraLength);
+            directory.skipRawData(commentLength);
+
+            Member member;
+            member.name = (flags & Utf8Flag) ? QString::fromUtf8(name) : QString::fromLatin1(name);
+            member.method = method;
+            member.compressedSize = compressedSize32;
+            member.size = size32;
+            member.headerOffset = headerOffset32;
+
+            // Values too large for the header are in the zip64 extra field, in this order
+            QDataStream extraFields(extra);
+            extraFields.setByteOrder(QDataStream::LittleEndian);
+            while (!extraFields.atEnd())
+            {
+                quint16 id, fieldSize;
+                extraFields >> id >> fieldSize;
+                if (extraFields.status() != QDataStream::Ok)
+                    break;
+                if (id != Zip64ExtraId)
+                {
+                    extraFields.skipRawData(fieldSize);
+                    continue;
+                }
+                if (size32 == Overflow32)
+                    extraFields >> member.size;
+                if (compressedSize32 == Overflow32)
+                    extraFields >> member.compressedSize;
+                if (headerOffset32 == Overflow32)
+                    extraFields >> member.headerOffset;
+                break;
+            }
+
+            // Folders, encrypted files and other compression methods are left out
+            const bool isReadable = !member.name.endsWith('/') && !(flags & EncryptedFlag) &&
+                                    (method == 0 || method == 8);
+            if (isReadable)
+                members.push_back(member);
+        }
+        return members;
+    }
+
+    QString MemberPath(const QString& zipPath, const QString& name)
+    {
+        return zipPath + "/" + name;
+    }
+
+    bool SplitMemberPath(const QString& path, QString& zipPath, QString& name)
+    {
+        if (QFileInfo::exists(path))
+            return false;
+
+        // A file cannot have children on disk, so the first existing file along the path is the archive
+        qsizetype slash = path.indexOf('/', 1);
+        while (slash > 0)
+        {
+            QFileInfo info(path.left(slash));
+            if (info.isFile())
+            {
+                if (!IsZip(info.filePath()))
+                    return false;
+                zipPath = info.filePath();
+                name = path.mid(slash + 1);
+                return true;
+            }
+            slash = path.indexOf('/', slash + 1);
+        }
+        return false;
+    }
+
+    bool FindMember(const QString& zipPath, const QString& name, Member& member)
+    {
+        static QMutex mutex;
+        static CachedArchive cache;
+
+        QFileInfo info(zipPath);
+        QMutexLocker locker(&mutex);
+        if (cache.path != zipPath || cache.size != info.size() || cache.modified != info.lastModified())
+        {
+            cache.path = zipPath;
+            cache.size = info.size();
+            cache.modified = info.lastModified();
+            cache.members.clear();
+            for (const Member& candidate : ReadMembers(zipPath))
+            {
+                cache.members.insert(candidate.name, candidate);
+            }
+        }
+
+        auto iter = cache.members.constFind(name);
+        if (iter == cache.members.constEnd())
+            return false;
+        member = iter.value();
+        return true;
+    }
+
+    qint64 DataOffset(const QString& zipPath, const Member& member)
+    {
+        QFile file(zipPath);
+        if (!file.open(QIODevice::ReadOnly))
+            return -1;
+
+        QDataStream header(ReadAt(file, member.headerOffset, LocalHeaderSize));
+        header.setByteOrder(QDataStream::LittleEndian);
+        quint32 magic;
+        header >> magic;
+        header.skipRawData(22);
+        quint16 nameLength, extraLength;
+        header >> nameLength >> extraLength;
+        if (header.status() != QDataStream::Ok || magic != LocalHeaderSignature)
+            return -1;
+        return member.headerOffset + LocalHeaderSize + nameLength + extraLength;
+    }
+}
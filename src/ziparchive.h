@@ -0,0 +1,38 @@
+#ifndef ZIPARCHIVE_H
+#define ZIPARCHIVE_H
+
+#include <QString>
+#include <vector>
+
+// Members of a zip archive, like a Tableau Server ziplogs bundle, so its logs can be read without
+// unpacking it. A member is named by the path of the archive followed by its path in the archive,
+// e.g. "C:/logs/ziplogs.zip/node1/vizqlserver/vizqlserver_0.txt".
+namespace ZipArchive
+{
+    struct Member
+    {
+        QString name;
+        // 0 for stored, 8 for deflated
+        quint16 method;
+        qint64 compressedSize;
+        qint64 size;
+        // Where the local header of the member starts, its data follows
+        qint64 headerOffset;
+    };
+
+    // True when the file starts with the zip magic bytes, whatever its extension
+    bool IsZip(const QString& path);
+    // The files in the archive that can be read, in the order of its central directory.
+    // Empty when the archive cannot be read.
+    std::vector<Member> ReadMembers(const QString& zipPath);
+
+    QString MemberPath(const QString& zipPath, const QString& name);
+    // Splits the path of a member into the archive and the member name. False for any other path.
+    bool SplitMemberPath(const QString& path, QString& zipPath, QString& name);
+    // Looks up a member by name. The directory of the last archive is kept, as a tree reads many of its members.
+    bool FindMember(const QString& zipPath, const QString& name, Member& member);
+    // Where the data of member starts in the archive, or -1 when its local header is not valid
+    qint64 DataOffset(const QString& zipPath, const Member& member);
+}
+
+#endif // ZIPARCHIVE_H
@@ -0,0 +1,9 @@
+# The viewer and its benchmark. Each can also be built on its own from its folder.
+TEMPLATE = subdirs
+
+SUBDIRS = \
+    app \
+    benchmark
+
+app.file = src/tableau-log-viewer.pro
+benchmark.file = benchmark/benchmark.pro